@@ -0,0 +1,305 @@
+/*
+ *  varint_blocks.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines functions that will serialize a sequence of
+ *      integers in fixed-size blocks, recording for each block a summary
+ *      holding the minimum and maximum values in the block, the number of
+ *      values, and the location of the block in the serialized data.
+ *
+ *      When searching the serialized data for values within a range, the
+ *      summaries allow entire blocks to be skipped without deserializing
+ *      them, as a block cannot contain a matching value if its maximum is
+ *      below the range or its minimum is above it.  This is particularly
+ *      effective for data that is ordered or clustered, such as timestamps.
+ *
+ *      The summaries may be kept in memory or serialized alongside the data
+ *      using SerializeSummaries().  The serialized data itself is identical
+ *      to that produced by the batch Serialize() function, so it may also
+ *      be read without the summaries.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VarIntEncoder
+{
+
+// Summary of one block of serialized integers
+template<typename T>
+struct BlockSummary
+{
+    T min{};                                // Smallest value in the block
+    T max{};                                // Largest value in the block
+    std::size_t count{0};                   // Number of values in the block
+    std::size_t offset{0};                  // Offset of the serialized block
+    std::size_t length{0};                  // Length of the serialized block
+};
+
+/*
+ *  SerializeBlocks()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, and produce a summary of each block of values.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *      block_size [in]
+ *          The number of values in each block.  The final block may hold
+ *          fewer values.
+ *
+ *      summaries [out]
+ *          The summaries of the blocks, which are appended to the vector.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      The serialized data is identical to that produced by the batch
+ *      Serialize() function.  Block offsets are relative to the start of
+ *      the buffer.  An error results if the buffer is too small, the block
+ *      size is zero, or there are no values; on error, the summaries are
+ *      left unchanged.
+ */
+std::size_t SerializeBlocks(
+    std::span<std::uint8_t> buffer,
+    std::span<const std::uint64_t> values,
+    std::size_t block_size,
+    std::vector<BlockSummary<std::uint64_t>> &summaries);
+
+/*
+ *  SerializeBlocks()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, and produce a summary of each block of values.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *      block_size [in]
+ *          The number of values in each block.  The final block may hold
+ *          fewer values.
+ *
+ *      summaries [out]
+ *          The summaries of the blocks, which are appended to the vector.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t SerializeBlocks(
+    std::span<std::uint8_t> buffer,
+    std::span<const std::int64_t> values,
+    std::size_t block_size,
+    std::vector<BlockSummary<std::int64_t>> &summaries);
+
+/*
+ *  ScanRange()
+ *
+ *  Description:
+ *      This function will find the values in serialized data that lie
+ *      within the given range, deserializing only those blocks whose
+ *      summaries indicate they may hold such values.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers, as produced by SerializeBlocks().
+ *
+ *      summaries [in]
+ *          The summaries of the blocks in the serialized data.
+ *
+ *      low [in]
+ *          The smallest value to find.
+ *
+ *      high [in]
+ *          The largest value to find.
+ *
+ *      matches [out]
+ *          The values found, in order, which are appended to the vector.
+ *
+ *  Returns:
+ *      True if successful, false if a block deserialized was invalid or
+ *      lies outside of the data.
+ *
+ *  Comments:
+ *      Blocks lying entirely within the range are deserialized directly
+ *      into the matches vector without examining each value.  Blocks that
+ *      are skipped are not validated.  On error, the contents of the
+ *      matches vector are unspecified.
+ */
+bool ScanRange(std::span<const std::uint8_t> data,
+               std::span<const BlockSummary<std::uint64_t>> summaries,
+               std::uint64_t low,
+               std::uint64_t high,
+               std::vector<std::uint64_t> &matches);
+
+/*
+ *  ScanRange()
+ *
+ *  Description:
+ *      This function will find the values in serialized data that lie
+ *      within the given range, deserializing only those blocks whose
+ *      summaries indicate they may hold such values.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers, as produced by SerializeBlocks().
+ *
+ *      summaries [in]
+ *          The summaries of the blocks in the serialized data.
+ *
+ *      low [in]
+ *          The smallest value to find.
+ *
+ *      high [in]
+ *          The largest value to find.
+ *
+ *      matches [out]
+ *          The values found, in order, which are appended to the vector.
+ *
+ *  Returns:
+ *      True if successful, false if a block deserialized was invalid or
+ *      lies outside of the data.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+bool ScanRange(std::span<const std::uint8_t> data,
+               std::span<const BlockSummary<std::int64_t>> summaries,
+               std::int64_t low,
+               std::int64_t high,
+               std::vector<std::int64_t> &matches);
+
+/*
+ *  SerializeSummaries()
+ *
+ *  Description:
+ *      This function will serialize the given block summaries into the
+ *      buffer so they may be stored alongside the serialized data.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the summaries.
+ *
+ *      summaries [in]
+ *          The summaries to serialize.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the summaries, or zero
+ *      if there was an error.
+ *
+ *  Comments:
+ *      The number of summaries is serialized first, followed by the count,
+ *      length, minimum, and maximum less the minimum of each block, all as
+ *      variable-length integers.  Offsets are not serialized, so the blocks
+ *      must follow one another from the start of the data, as they do when
+ *      produced by SerializeBlocks(); otherwise, zero is returned.
+ */
+std::size_t SerializeSummaries(
+    std::span<std::uint8_t> buffer,
+    std::span<const BlockSummary<std::uint64_t>> summaries);
+
+/*
+ *  DeserializeSummaries()
+ *
+ *  Description:
+ *      This function will deserialize block summaries serialized using
+ *      SerializeSummaries().
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the summaries.
+ *
+ *      summaries [out]
+ *          The summaries read from the buffer, which are appended to the
+ *          vector.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      On error, the summaries are left unchanged.
+ */
+std::size_t DeserializeSummaries(
+    std::span<const std::uint8_t> buffer,
+    std::vector<BlockSummary<std::uint64_t>> &summaries);
+
+/*
+ *  SerializeSummaries()
+ *
+ *  Description:
+ *      This function will serialize the given block summaries into the
+ *      buffer so they may be stored alongside the serialized data.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the summaries.
+ *
+ *      summaries [in]
+ *          The summaries to serialize.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the summaries, or zero
+ *      if there was an error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t SerializeSummaries(
+    std::span<std::uint8_t> buffer,
+    std::span<const BlockSummary<std::int64_t>> summaries);
+
+/*
+ *  DeserializeSummaries()
+ *
+ *  Description:
+ *      This function will deserialize block summaries serialized using
+ *      SerializeSummaries().
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the summaries.
+ *
+ *      summaries [out]
+ *          The summaries read from the buffer, which are appended to the
+ *          vector.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t DeserializeSummaries(
+    std::span<const std::uint8_t> buffer,
+    std::vector<BlockSummary<std::int64_t>> &summaries);
+
+} // namespace VarIntEncoder
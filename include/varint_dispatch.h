@@ -0,0 +1,113 @@
+/*
+ *  varint_dispatch.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines functions to query and select the kernel tier
+ *      used by the functions that serialize or deserialize many integers
+ *      at once.  On first use, the fastest tier supported by the processor
+ *      is selected.  That selection may be overridden by setting the
+ *      environment variable VARINT_ENCODER_TIER to the name of a tier
+ *      (e.g., "scalar"), though a tier the processor does not support
+ *      will never be selected.  This is intended for A/B testing and
+ *      debugging.
+ *
+ *      The scalar tier calls Serialize() or Deserialize() for each integer
+ *      and serves as the reference against which other tiers are tested.
+ *
+ *  Portability Issues:
+ *      The AVX-512 tier is only available on x86 processors supporting
+ *      AVX-512 F, BW, CD, VBMI, and VBMI2 (e.g., Intel Ice Lake and later,
+ *      AMD Zen 4 and later) when built with GCC or Clang.
+ */
+
+#pragma once
+
+namespace VarIntEncoder
+{
+
+// Kernel tiers, from slowest to fastest
+enum class KernelTier
+{
+    Scalar,
+    AVX512
+};
+
+/*
+ *  GetKernelTier()
+ *
+ *  Description:
+ *      This function will return the kernel tier presently in use.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The kernel tier presently in use.
+ *
+ *  Comments:
+ *      None.
+ */
+KernelTier GetKernelTier();
+
+/*
+ *  SetKernelTier()
+ *
+ *  Description:
+ *      This function will select the kernel tier to use.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier to use.
+ *
+ *  Returns:
+ *      True if the tier was selected, false if the tier is not supported
+ *      by this processor, in which case the tier in use is unchanged.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SetKernelTier(KernelTier tier);
+
+/*
+ *  IsKernelTierSupported()
+ *
+ *  Description:
+ *      This function will determine whether the given kernel tier is
+ *      supported by this processor.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier in question.
+ *
+ *  Returns:
+ *      True if the tier is supported, false if not.
+ *
+ *  Comments:
+ *      None.
+ */
+bool IsKernelTierSupported(KernelTier tier);
+
+/*
+ *  GetKernelTierName()
+ *
+ *  Description:
+ *      This function will return the name of the given kernel tier, as
+ *      used with the VARINT_ENCODER_TIER environment variable.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier whose name is sought.
+ *
+ *  Returns:
+ *      The name of the kernel tier.
+ *
+ *  Comments:
+ *      None.
+ */
+const char *GetKernelTierName(KernelTier tier);
+
+} // namespace VarIntEncoder
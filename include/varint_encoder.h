@@ -20,8 +20,14 @@
  *      The '^' character marks the position of the bit indicating whether the
  *      next octet contains additional bits of the integer or not.
  *
+ *      Functions are also provided to serialize integers using LEB128, as
+ *      used by Protocol Buffers, DWARF, and WebAssembly.  LEB128 uses the
+ *      same continuation bit, but groups of 7 bits are ordered from least
+ *      significant to most significant.
+ *
  *  Portability Issues:
- *      None.
+ *      The 128-bit integer functions are available only when the compiler
+ *      provides the __int128 types (i.e., when __SIZEOF_INT128__ is defined).
  */
 
 #pragma once
@@ -75,9 +81,11 @@ std::size_t Serialize(std::span<std::uint8_t> buffer, std::uint64_t value);
  *      there was a deserialization error.
  *
  *  Comments:
- *      None.
+ *      Non-minimal encodings having leading 0x80 padding octets, such as
+ *      those produced by the form of Serialize() taking a minimum number of
+ *      octets, are accepted.
  */
-std::size_t Deserialize(const std::span<std::uint8_t> buffer,
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
                         std::uint64_t &value);
 
 /*
@@ -122,9 +130,536 @@ std::size_t Serialize(std::span<std::uint8_t> buffer, std::int64_t value);
  *      there was a deserialization error.
  *
  *  Comments:
- *      None.
+ *      Non-minimal encodings having leading 0x80 (non-negative) or 0xff
+ *      (negative) padding octets are accepted.
  */
-std::size_t Deserialize(const std::span<std::uint8_t> buffer,
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
                         std::int64_t &value);
 
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      variable-length integer encoding, occupying at least the given
+ *      number of octets.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *      min_octets [in]
+ *          The minimum number of octets to occupy, which may not exceed 10.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      The integer is padded with leading 0x80 octets as required, which
+ *      Deserialize() accepts.  This allows space to be reserved for an
+ *      integer (e.g., a length) whose value is later written in place using
+ *      Rewrite().
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::uint64_t value,
+                      std::size_t min_octets);
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      variable-length integer encoding, occupying at least the given
+ *      number of octets.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *      min_octets [in]
+ *          The minimum number of octets to occupy, which may not exceed 10.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      The integer is padded with leading 0x80 octets if non-negative or
+ *      0xff octets if negative, as required.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::int64_t value,
+                      std::size_t min_octets);
+
+/*
+ *  Rewrite()
+ *
+ *  Description:
+ *      This function will replace the variable-length integer encoded at the
+ *      start of the given buffer with the given value, occupying exactly the
+ *      same number of octets.
+ *
+ *  Parameters:
+ *      buffer [in/out]
+ *          The buffer holding the integer to replace.
+ *
+ *      value [in]
+ *          The value to write in place of the existing integer.
+ *
+ *  Returns:
+ *      The number of octets occupied by the integer, or zero if the buffer
+ *      does not begin with a valid integer or the value does not fit in the
+ *      octets occupied by the existing integer.  The buffer is not modified
+ *      if zero is returned.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Rewrite(std::span<std::uint8_t> buffer, std::uint64_t value);
+
+/*
+ *  Rewrite()
+ *
+ *  Description:
+ *      This function will replace the variable-length integer encoded at the
+ *      start of the given buffer with the given value, occupying exactly the
+ *      same number of octets.
+ *
+ *  Parameters:
+ *      buffer [in/out]
+ *          The buffer holding the integer to replace.
+ *
+ *      value [in]
+ *          The value to write in place of the existing integer.
+ *
+ *  Returns:
+ *      The number of octets occupied by the integer, or zero if the buffer
+ *      does not begin with a valid integer or the value does not fit in the
+ *      octets occupied by the existing integer.  The buffer is not modified
+ *      if zero is returned.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Rewrite(std::span<std::uint8_t> buffer, std::int64_t value);
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      The output is identical to calling Serialize() for each value.  The
+ *      work is performed by the fastest kernel supported by the processor
+ *      (see varint_dispatch.h).  If the buffer is too small, zero is
+ *      returned and the buffer contents are unspecified.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const std::uint64_t> values);
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length integers
+ *      encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.  Exactly this number of values
+ *          is deserialized.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      The result is identical to calling Deserialize() for each value.  The
+ *      work is performed by the fastest kernel supported by the processor
+ *      (see varint_dispatch.h).
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<std::uint64_t> values);
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const std::int64_t> values);
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length integers
+ *      encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.  Exactly this number of values
+ *          is deserialized.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<std::int64_t> values);
+
+/*
+ *  SerializeLEB128()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      unsigned LEB128 encoding.  This is the encoding used by Protocol
+ *      Buffers for unsigned integer fields.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeLEB128(std::span<std::uint8_t> buffer,
+                            std::uint64_t value);
+
+/*
+ *  DeserializeLEB128()
+ *
+ *  Description:
+ *      This function will deserialize the unsigned LEB128 integer that is
+ *      encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t DeserializeLEB128(std::span<const std::uint8_t> buffer,
+                              std::uint64_t &value);
+
+/*
+ *  SerializeLEB128()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      signed LEB128 encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      Protocol Buffers encodes int64 fields as unsigned LEB128 values
+ *      (i.e., by casting to std::uint64_t), and sint64 fields as unsigned
+ *      LEB128 values after ZigZag encoding.  Signed LEB128 is the encoding
+ *      used by DWARF and WebAssembly.
+ */
+std::size_t SerializeLEB128(std::span<std::uint8_t> buffer,
+                            std::int64_t value);
+
+/*
+ *  DeserializeLEB128()
+ *
+ *  Description:
+ *      This function will deserialize the signed LEB128 integer that is
+ *      encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t DeserializeLEB128(std::span<const std::uint8_t> buffer,
+                              std::int64_t &value);
+
+#if defined(__SIZEOF_INT128__)
+
+// 128-bit integer types (a GCC / Clang extension)
+__extension__ typedef unsigned __int128 uint128_t;
+__extension__ typedef __int128 int128_t;
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit value into the buffer
+ *      using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      A 128-bit value requires at most 19 octets.  Values that fit within
+ *      64 bits are serialized exactly as the 64-bit Serialize() would.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer, uint128_t value);
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize the 128-bit variable-length integer
+ *      that is encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      If the total length is 19 octets, the initial octet must be in the
+ *      range 0x80 to 0x83, as other values would overflow 128 bits.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        uint128_t &value);
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit value into the buffer
+ *      using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      A 128-bit value requires at most 19 octets.  Values that fit within
+ *      64 bits are serialized exactly as the 64-bit Serialize() would.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer, int128_t value);
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize the 128-bit variable-length integer
+ *      that is encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      If the total length is 19 octets, the initial octet must be one of
+ *      0x80, 0x81, 0xfe, or 0xff, as other values would overflow 128 bits.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        int128_t &value);
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit values into the buffer,
+ *      one after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      The output is identical to calling Serialize() for each value.  Runs
+ *      of values having a zero high word are handed to the 64-bit batch
+ *      kernel, so sequences of mostly small values are serialized quickly.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const uint128_t> values);
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of 128-bit variable-length
+ *      integers encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.  Exactly this number of values
+ *          is deserialized.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      The result is identical to calling Deserialize() for each value.
+ *      Values are first deserialized in groups using the 64-bit batch
+ *      kernel; only a group containing a value that does not fit within 64
+ *      bits is deserialized one value at a time.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<uint128_t> values);
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit values into the buffer,
+ *      one after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const int128_t> values);
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of 128-bit variable-length
+ *      integers encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.  Exactly this number of values
+ *          is deserialized.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      See the unsigned form of this function.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<int128_t> values);
+
+#endif // __SIZEOF_INT128__
+
 } // namespace VarIntEncoder
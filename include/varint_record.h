@@ -0,0 +1,503 @@
+/*
+ *  varint_record.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines the RecordSchema template, which will serialize
+ *      and deserialize entire structures whose members are integers.  A
+ *      schema is described as a list of pointers to the structure members,
+ *      each of which is serialized as a variable-length integer in the
+ *      order given.  Signed members are serialized as signed integers and
+ *      unsigned members as unsigned integers, so the encoding of each
+ *      member is identical to that produced by Serialize().
+ *
+ *      For example:
+ *
+ *          struct Message
+ *          {
+ *              std::uint32_t id;
+ *              std::int64_t delta;
+ *              std::uint8_t flags;
+ *          };
+ *
+ *          using MessageSchema = RecordSchema<Message,
+ *                                             &Message::id,
+ *                                             &Message::delta,
+ *                                             &Message::flags>;
+ *
+ *      The maximum serialized size of a record is computed at compile time
+ *      (MessageSchema::Max_Size is 5 + 10 + 2 = 17 octets), so a single
+ *      buffer length check per record suffices, after which all members are
+ *      serialized or deserialized with straight-line inline code.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace VarIntEncoder
+{
+
+namespace RecordInternal
+{
+
+// Determine the structure and member types from a pointer to member
+template<typename T>
+struct MemberPointer;
+
+template<typename C, typename M>
+struct MemberPointer<M C::*>
+{
+    using Class = C;
+    using Member = M;
+};
+
+template<auto Member>
+using MemberType = typename MemberPointer<decltype(Member)>::Member;
+
+/*
+ *  MaxOctets()
+ *
+ *  Description:
+ *      This function will return the maximum number of octets required to
+ *      serialize an integer of the given type.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The maximum number of octets required to serialize an integer of
+ *      type T.
+ *
+ *  Comments:
+ *      Signed integers require an additional bit to convey the sign.
+ */
+template<typename T>
+constexpr std::size_t MaxOctets()
+{
+    constexpr std::size_t bits = std::numeric_limits<T>::digits +
+                                 (std::is_signed_v<T> ? 1 : 0);
+
+    return (bits + 6) / 7;
+}
+
+/*
+ *  SerializeField()
+ *
+ *  Description:
+ *      This function will serialize the given integer without checking the
+ *      size of the buffer.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.  This must have
+ *          at least MaxOctets<T>() octets available.
+ *
+ *      value [in]
+ *          The value to serialize.
+ *
+ *  Returns:
+ *      The number of octets written to the buffer.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+inline std::size_t SerializeField(std::uint8_t *buffer, T value)
+{
+    std::size_t octets_required;
+
+    if constexpr (std::is_signed_v<T>)
+    {
+        std::int64_t v = value;
+        std::uint64_t magnitude = static_cast<std::uint64_t>(v ^ (v >> 63));
+
+        octets_required = (std::bit_width(magnitude) + 7) / 7;
+
+        // Write octets from right to left (reverse order)
+        buffer[octets_required - 1] = v & 0x7f;
+        for (std::size_t i = octets_required - 1; i > 0; i--)
+        {
+            v >>= 7;
+            buffer[i - 1] = (v & 0x7f) | 0x80;
+        }
+    }
+    else
+    {
+        std::uint64_t v = value;
+        std::size_t bits = std::bit_width(v);
+
+        octets_required = (bits ? bits + 6 : 7) / 7;
+
+        // Write octets from right to left (reverse order)
+        buffer[octets_required - 1] = v & 0x7f;
+        for (std::size_t i = octets_required - 1; i > 0; i--)
+        {
+            v >>= 7;
+            buffer[i - 1] = (v & 0x7f) | 0x80;
+        }
+    }
+
+    return octets_required;
+}
+
+/*
+ *  DeserializeField()
+ *
+ *  Description:
+ *      This function will deserialize an integer without checking the
+ *      size of the buffer, verifying that the value may be represented
+ *      using the given type.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.  This must have
+ *          at least MaxOctets<T>() octets available.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      Non-minimal encodings having leading padding octets are accepted
+ *      when the value is in range.
+ */
+template<typename T>
+inline std::size_t DeserializeField(const std::uint8_t *buffer, T &value)
+{
+    constexpr std::size_t limit = MaxOctets<T>();
+
+    if constexpr (std::is_signed_v<T>)
+    {
+        // Determine the sign of the number by inspecting the leading sign bit
+        std::int64_t v = (buffer[0] & 0x40) ? -1 : 0;
+
+        for (std::size_t i = 0; i < limit; i++)
+        {
+            v = static_cast<std::int64_t>(
+                    (static_cast<std::uint64_t>(v) << 7) | (buffer[i] & 0x7f));
+
+            if (buffer[i] & 0x80) continue;
+
+            if constexpr (limit * 7 > 64)
+            {
+                // The leading octet must only extend the sign bit
+                if ((i == limit - 1) && (buffer[0] != 0x80) &&
+                    (buffer[0] != 0xff))
+                {
+                    return 0;
+                }
+            }
+            else
+            {
+                if ((v < std::numeric_limits<T>::min()) ||
+                    (v > std::numeric_limits<T>::max()))
+                {
+                    return 0;
+                }
+            }
+
+            value = static_cast<T>(v);
+
+            return i + 1;
+        }
+    }
+    else
+    {
+        std::uint64_t v = 0;
+
+        for (std::size_t i = 0; i < limit; i++)
+        {
+            v = (v << 7) | (buffer[i] & 0x7f);
+
+            if (buffer[i] & 0x80) continue;
+
+            if constexpr (limit * 7 > 64)
+            {
+                // The leading octet may only contain bits of the integer
+                if ((i == limit - 1) &&
+                    ((buffer[0] & 0x7f) >>
+                     (std::numeric_limits<T>::digits - 7 * (limit - 1))))
+                {
+                    return 0;
+                }
+            }
+            else
+            {
+                if (v > std::numeric_limits<T>::max()) return 0;
+            }
+
+            value = static_cast<T>(v);
+
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace RecordInternal
+
+/*
+ *  RecordSchema
+ *
+ *  Description:
+ *      This template describes how a structure of type Record is serialized,
+ *      with Members being a list of pointers to the integer members of the
+ *      structure to serialize, in order.
+ *
+ *  Comments:
+ *      Members may be of any integer type other than bool.
+ */
+template<typename Record, auto... Members>
+class RecordSchema
+{
+    static_assert(sizeof...(Members) > 0, "A schema requires members");
+    static_assert(
+        (std::is_same_v<
+             typename RecordInternal::MemberPointer<decltype(Members)>::Class,
+             Record> && ...),
+        "Schema members must be members of the record type");
+    static_assert(
+        ((std::is_integral_v<RecordInternal::MemberType<Members>> &&
+          !std::is_same_v<RecordInternal::MemberType<Members>, bool>) && ...),
+        "Schema members must be integers");
+    static_assert(
+        ((sizeof(RecordInternal::MemberType<Members>) <= 8) && ...),
+        "Schema members must be no larger than 64 bits");
+
+    public:
+        // Maximum number of octets required to serialize a record
+        static constexpr std::size_t Max_Size =
+            (RecordInternal::MaxOctets<RecordInternal::MemberType<Members>>() +
+             ...);
+
+        /*
+         *  Serialize()
+         *
+         *  Description:
+         *      This function will serialize the given record into the buffer
+         *      using variable-length integer encoding for each member.
+         *
+         *  Parameters:
+         *      buffer [out]
+         *          The buffer into which to serialize the record.
+         *
+         *      record [in]
+         *          The record to serialize.
+         *
+         *  Returns:
+         *      The number of octets required to serialize the record, or
+         *      zero if there was an error.
+         *
+         *  Comments:
+         *      If the buffer is smaller than Max_Size, the record is
+         *      serialized into temporary storage and then copied if it fits.
+         */
+        static std::size_t Serialize(std::span<std::uint8_t> buffer,
+                                     const Record &record)
+        {
+            if (buffer.size() >= Max_Size)
+            {
+                return SerializeUnchecked(buffer.data(), record);
+            }
+
+            std::uint8_t octets[Max_Size];
+            std::size_t length = SerializeUnchecked(octets, record);
+            if (length > buffer.size()) return 0;
+
+            std::memcpy(buffer.data(), octets, length);
+
+            return length;
+        }
+
+        /*
+         *  Deserialize()
+         *
+         *  Description:
+         *      This function will deserialize a record that is encoded in
+         *      the given buffer.
+         *
+         *  Parameters:
+         *      buffer [in]
+         *          The buffer from which to deserialize the record.
+         *
+         *      record [out]
+         *          The record read from the buffer.
+         *
+         *  Returns:
+         *      The number of octets deserialized from the buffer.  A zero
+         *      indicates there was a deserialization error, including any
+         *      member value outside the range of the member's type.
+         *
+         *  Comments:
+         *      If the buffer is smaller than Max_Size, the available octets
+         *      are copied into temporary storage before deserializing.
+         */
+        static std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                                       Record &record)
+        {
+            if (buffer.size() >= Max_Size)
+            {
+                return DeserializeUnchecked(buffer.data(), record);
+            }
+
+            // Any read beyond the end of the buffer is detected by length
+            std::uint8_t octets[Max_Size]{};
+            if (!buffer.empty())
+            {
+                std::memcpy(octets, buffer.data(), buffer.size());
+            }
+
+            std::size_t length = DeserializeUnchecked(octets, record);
+
+            return (length <= buffer.size()) ? length : 0;
+        }
+
+        /*
+         *  Serialize()
+         *
+         *  Description:
+         *      This function will serialize the given records into the
+         *      buffer, one after another.
+         *
+         *  Parameters:
+         *      buffer [out]
+         *          The buffer into which to serialize the records.
+         *
+         *      records [in]
+         *          The records to serialize.
+         *
+         *  Returns:
+         *      The number of octets required to serialize the records, or
+         *      zero if there was an error.
+         *
+         *  Comments:
+         *      None.
+         */
+        static std::size_t Serialize(std::span<std::uint8_t> buffer,
+                                     std::span<const Record> records)
+        {
+            std::uint8_t *p = buffer.data();
+            std::size_t remaining = buffer.size();
+
+            for (const Record &record : records)
+            {
+                std::size_t length;
+
+                if (remaining >= Max_Size)
+                {
+                    length = SerializeUnchecked(p, record);
+                }
+                else
+                {
+                    length = Serialize(std::span<std::uint8_t>(p, remaining),
+                                       record);
+                    if (length == 0) return 0;
+                }
+
+                p += length;
+                remaining -= length;
+            }
+
+            return buffer.size() - remaining;
+        }
+
+        /*
+         *  Deserialize()
+         *
+         *  Description:
+         *      This function will deserialize records encoded one after
+         *      another in the given buffer, filling the given span.
+         *
+         *  Parameters:
+         *      buffer [in]
+         *          The buffer from which to deserialize the records.
+         *
+         *      records [out]
+         *          The records read from the buffer.  Exactly this number of
+         *          records is deserialized.
+         *
+         *  Returns:
+         *      The number of octets deserialized from the buffer.  A zero
+         *      indicates there was a deserialization error.
+         *
+         *  Comments:
+         *      None.
+         */
+        static std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                                       std::span<Record> records)
+        {
+            const std::uint8_t *p = buffer.data();
+            std::size_t remaining = buffer.size();
+
+            for (Record &record : records)
+            {
+                std::size_t length;
+
+                if (remaining >= Max_Size)
+                {
+                    length = DeserializeUnchecked(p, record);
+                }
+                else
+                {
+                    length = Deserialize(
+                        std::span<const std::uint8_t>(p, remaining),
+                        record);
+                }
+
+                if (length == 0) return 0;
+
+                p += length;
+                remaining -= length;
+            }
+
+            return buffer.size() - remaining;
+        }
+
+    protected:
+        static std::size_t SerializeUnchecked(std::uint8_t *buffer,
+                                              const Record &record)
+        {
+            std::uint8_t *p = buffer;
+
+            ((p += RecordInternal::SerializeField(p, record.*Members)), ...);
+
+            return static_cast<std::size_t>(p - buffer);
+        }
+
+        static std::size_t DeserializeUnchecked(const std::uint8_t *buffer,
+                                                Record &record)
+        {
+            const std::uint8_t *p = buffer;
+            std::size_t length;
+
+            // Deserialize each member in turn, stopping on error
+            if (((length = RecordInternal::DeserializeField(p,
+                                                            record.*Members),
+                  p += length,
+                  length != 0) && ...))
+            {
+                return static_cast<std::size_t>(p - buffer);
+            }
+
+            return 0;
+        }
+};
+
+} // namespace VarIntEncoder
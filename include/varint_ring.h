@@ -0,0 +1,103 @@
+/*
+ *  varint_ring.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines the SharedRing object, which is a single-producer,
+ *      single-consumer ring buffer in shared memory through which records
+ *      may be passed between processes without copying them through the
+ *      kernel.  Each record is written into the ring preceded by its length,
+ *      serialized as a variable-length integer.
+ *
+ *      One process creates the ring using Create() and shares the file
+ *      descriptor returned by FileDescriptor() with the other process,
+ *      either by fork() or by passing it over a Unix domain socket.  The
+ *      other process then calls Attach().  One process writes records using
+ *      Reserve() and Commit() (or Write()), while the other reads records
+ *      in place using Read() and then calls Release() once it no longer
+ *      needs them.  Read() itself releases the records read so far before
+ *      waiting on an empty ring, so a record must not be used after the
+ *      following call to Read().
+ *
+ *      The data region of the ring is mapped twice, one mapping immediately
+ *      following the other, so every record is contiguous in memory even
+ *      when it wraps around the end of the ring.  Neither process enters
+ *      the kernel while the ring is neither empty nor full; a process
+ *      waiting for data or space sleeps on a futex and is woken only if
+ *      it is waiting.
+ *
+ *  Portability Issues:
+ *      This module requires a POSIX system.  On Linux, the ring is created
+ *      using memfd_create() and waiting is performed using futexes.  On
+ *      other systems, shm_open() is used and a waiting process polls.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VarIntEncoder
+{
+
+class SharedRing
+{
+    public:
+        SharedRing() = default;
+        SharedRing(const SharedRing &) = delete;
+        SharedRing &operator=(const SharedRing &) = delete;
+        ~SharedRing();
+
+        bool Create(std::size_t capacity);
+        bool Attach(int fd);
+        void Close();
+
+        bool IsOpen() const { return header != nullptr; }
+        int FileDescriptor() const { return fd; }
+        std::size_t Capacity() const { return capacity; }
+
+        // Functions called by the producer
+        bool TryReserve(std::size_t length, std::span<std::uint8_t> &record);
+        bool Reserve(std::size_t length, std::span<std::uint8_t> &record);
+        void Commit();
+        bool TryWrite(std::span<const std::uint8_t> record);
+        bool Write(std::span<const std::uint8_t> record);
+
+        // Functions called by the consumer
+        bool TryRead(std::span<const std::uint8_t> &record);
+        bool Read(std::span<const std::uint8_t> &record);
+        void Release();
+
+        // Functions called by either process
+        void Shutdown();
+        bool IsShutdown() const;
+
+    protected:
+        struct Header;
+
+        bool Map(std::size_t size);
+        bool WaitForSpace(std::size_t length);
+        bool WaitForData();
+
+        int fd{-1};
+        Header *header{nullptr};
+        std::uint8_t *data{nullptr};
+        void *mapping{nullptr};
+        std::size_t mapping_size{0};
+        std::size_t capacity{0};
+
+        // Producer state
+        std::uint64_t write_position{0};
+        std::uint64_t pending_position{0};
+        std::uint64_t cached_tail{0};
+
+        // Consumer state
+        std::uint64_t read_position{0};
+        std::uint64_t cached_head{0};
+};
+
+} // namespace VarIntEncoder
@@ -0,0 +1,66 @@
+/*
+ *  varint_segmented.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines the SegmentedReader object, which will
+ *      deserialize variable-length integers from a sequence of buffers
+ *      (segments), such as a chain of network buffers, without first
+ *      copying the segments into one contiguous buffer.  An integer may
+ *      begin in one segment and end in a later one.
+ *
+ *      Integers lying entirely within a segment are deserialized directly
+ *      from the segment using the contiguous Deserialize() functions.  Only
+ *      an integer that crosses a segment boundary is copied (at most 10
+ *      octets) into a temporary buffer and deserialized from there.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VarIntEncoder
+{
+
+class SegmentedReader
+{
+    public:
+        SegmentedReader() = default;
+        explicit SegmentedReader(
+            std::span<const std::span<const std::uint8_t>> segments);
+
+        std::size_t Deserialize(std::uint64_t &value);
+        std::size_t Deserialize(std::int64_t &value);
+        std::size_t Deserialize(std::span<std::uint64_t> values);
+        std::size_t Deserialize(std::span<std::int64_t> values);
+
+        std::uint64_t Position() const { return position; }
+        bool AtEnd();
+
+    protected:
+        template<typename T>
+        std::size_t DeserializeValue(T &value);
+        template<typename T>
+        std::size_t DeserializeValues(std::span<T> values);
+        template<typename T>
+        std::size_t DeserializeStitched(T &value);
+
+        std::span<const std::uint8_t> Current() const;
+        void SkipEmpty();
+        void Advance(std::size_t length);
+
+        std::span<const std::span<const std::uint8_t>> segments;
+        std::size_t segment{0};
+        std::size_t offset{0};
+        std::uint64_t position{0};
+};
+
+} // namespace VarIntEncoder
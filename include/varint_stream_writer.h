@@ -0,0 +1,122 @@
+/*
+ *  varint_stream_writer.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines the StreamWriter object, which will serialize
+ *      variable-length integers into a set of large, aligned buffers and
+ *      write those buffers to a file asynchronously.  While one buffer is
+ *      being written to the file, integers are serialized into the next
+ *      buffer, allowing the encoding work and the disk writes to overlap.
+ *
+ *      On Linux, buffers are submitted using io_uring.  Where io_uring is
+ *      not available (or if not requested), buffers are written using
+ *      pwrite().  The file may optionally be opened using O_DIRECT so
+ *      that data is transferred without passing through the page cache.
+ *
+ *  Portability Issues:
+ *      This module requires a POSIX system.  The io_uring interface is
+ *      only used on Linux.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace VarIntEncoder
+{
+
+// Options that control the behavior of the StreamWriter
+struct StreamWriterOptions
+{
+    // Size of each buffer (rounded up to a multiple of 4096 octets)
+    std::size_t buffer_size{1 << 20};
+
+    // Number of buffers (at least 2); all but one may be in flight
+    std::size_t buffer_count{4};
+
+    // Open the file using O_DIRECT, if supported by the file system
+    bool direct_io{false};
+
+    // Use io_uring when available, else use pwrite()
+    bool use_io_uring{true};
+};
+
+class StreamWriter
+{
+    public:
+        StreamWriter() = default;
+        StreamWriter(const StreamWriter &) = delete;
+        StreamWriter &operator=(const StreamWriter &) = delete;
+        ~StreamWriter();
+
+        bool Open(const std::string &filename,
+                  const StreamWriterOptions &options = {});
+        bool Close();
+
+        bool Write(std::uint64_t value);
+        bool Write(std::int64_t value);
+        bool Write(std::span<const std::uint8_t> data);
+        bool Flush();
+
+        bool IsOpen() const { return fd >= 0; }
+        bool UsingIoUring() const { return ring_fd >= 0; }
+        bool UsingDirectIO() const { return direct_io; }
+        std::uint64_t BytesWritten() const { return file_offset + position; }
+
+    protected:
+        struct Buffer
+        {
+            std::uint8_t *data{nullptr};
+            std::size_t length{0};
+            std::uint64_t offset{0};
+            bool in_flight{false};
+        };
+
+        bool SetupIoUring(unsigned entries);
+        void TeardownIoUring();
+        bool SubmitBuffer();
+        bool WriteBuffer(std::size_t index,
+                         std::size_t length,
+                         std::uint64_t offset);
+        bool CompleteWrite(std::size_t index, std::size_t written);
+        bool ReapCompletions();
+        bool WaitForBuffer(std::size_t index);
+        bool WaitForAll();
+        void ReleaseResources();
+
+        int fd{-1};
+        bool direct_io{false};
+        bool failed{false};
+        std::size_t buffer_size{0};
+        std::vector<Buffer> buffers;
+        std::size_t current{0};
+        std::size_t position{0};
+        std::uint64_t file_offset{0};
+        std::size_t in_flight{0};
+
+        // io_uring state (unused when writing with pwrite())
+        int ring_fd{-1};
+        void *sq_ring{nullptr};
+        std::size_t sq_ring_size{0};
+        void *cq_ring{nullptr};
+        std::size_t cq_ring_size{0};
+        void *sqes{nullptr};
+        std::size_t sqes_size{0};
+        unsigned *sq_tail{nullptr};
+        unsigned *sq_mask{nullptr};
+        unsigned *sq_array{nullptr};
+        unsigned *cq_head{nullptr};
+        unsigned *cq_tail{nullptr};
+        unsigned *cq_mask{nullptr};
+        void *cqes{nullptr};
+};
+
+} // namespace VarIntEncoder
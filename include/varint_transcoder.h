@@ -0,0 +1,428 @@
+/*
+ *  varint_transcoder.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines functions that will convert entire buffers of
+ *      serialized integers between the variable-length integer encoding
+ *      produced by this library and other integer encodings, without
+ *      deserializing the integers into an intermediate array.
+ *
+ *      Conversions to and from QUIC (RFC 9000) and CBOR (RFC 8949) integers
+ *      change the size of each integer, so each such function is paired
+ *      with one that determines the exact size of the output buffer
+ *      required.  Success is indicated by a non-zero return value or, for
+ *      an empty input buffer, by consumed being equal to the input size.
+ *      On error, consumed gives the offset of the integer that could not
+ *      be transcoded, such as a value too large for the target encoding.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VarIntEncoder
+{
+
+/*
+ *  TranscodeToLEB128()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      variable-length integers serialized by Serialize() into the same
+ *      sequence of integers serialized using LEB128.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the serialized integers.
+ *
+ *      output [out]
+ *          The buffer into which to write the LEB128 integers.  This must
+ *          be at least as large as the input buffer and may be the same
+ *          buffer as the input, but must not otherwise overlap it.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, which is always
+ *      equal to the size of the input buffer, or zero if there was an error.
+ *
+ *  Comments:
+ *      Each integer occupies the same number of octets in both encodings,
+ *      so no size calculation is required.  Unsigned integers are converted
+ *      to unsigned LEB128 and signed integers to signed LEB128, so it is
+ *      not necessary to know which the buffer contains.  An error results
+ *      if the final integer is incomplete, any integer is longer than
+ *      10 octets, or a 10-octet integer holds more than 64 bits (i.e., the
+ *      most significant group is other than 0x00, 0x01, or 0x7f).
+ */
+std::size_t TranscodeToLEB128(std::span<const std::uint8_t> input,
+                              std::span<std::uint8_t> output);
+
+/*
+ *  TranscodeFromLEB128()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      LEB128 integers into the same sequence of integers serialized
+ *      as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the LEB128 integers.
+ *
+ *      output [out]
+ *          The buffer into which to write the serialized integers.  This must
+ *          be at least as large as the input buffer and may be the same
+ *          buffer as the input, but must not otherwise overlap it.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, which is always
+ *      equal to the size of the input buffer, or zero if there was an error.
+ *
+ *  Comments:
+ *      See TranscodeToLEB128().
+ */
+std::size_t TranscodeFromLEB128(std::span<const std::uint8_t> input,
+                                std::span<std::uint8_t> output);
+
+/*
+ *  TranscodeToQUIC()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      unsigned integers serialized by Serialize() into the same sequence of
+ *      integers serialized using QUIC variable-length encoding.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Values greater than 2^62 - 1 cannot be represented and result in an
+ *      error.
+ */
+std::size_t TranscodeToQUIC(std::span<const std::uint8_t> input,
+                            std::span<std::uint8_t> output,
+                            std::size_t &consumed);
+
+/*
+ *  TranscodeToQUICSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeToQUIC() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToQUICSize(std::span<const std::uint8_t> input,
+                                std::size_t &consumed);
+
+/*
+ *  TranscodeFromQUIC()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      QUIC variable-length integers into the same sequence of
+ *      unsigned integers serialized as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromQUIC(std::span<const std::uint8_t> input,
+                              std::span<std::uint8_t> output,
+                              std::size_t &consumed);
+
+/*
+ *  TranscodeFromQUICSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeFromQUIC() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromQUICSize(std::span<const std::uint8_t> input,
+                                  std::size_t &consumed);
+
+/*
+ *  TranscodeToCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      unsigned integers serialized by Serialize() into the same sequence of
+ *      integers serialized as CBOR major type 0 data items.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToCBOR(std::span<const std::uint8_t> input,
+                            std::span<std::uint8_t> output,
+                            std::size_t &consumed);
+
+/*
+ *  TranscodeToCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeToCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToCBORSize(std::span<const std::uint8_t> input,
+                                std::size_t &consumed);
+
+/*
+ *  TranscodeFromCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      CBOR major type 0 data items into the same sequence of
+ *      unsigned integers serialized as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Negative integers (major type 1) and other data items cannot be
+ *      represented and result in an error.
+ */
+std::size_t TranscodeFromCBOR(std::span<const std::uint8_t> input,
+                              std::span<std::uint8_t> output,
+                              std::size_t &consumed);
+
+/*
+ *  TranscodeFromCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeFromCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromCBORSize(std::span<const std::uint8_t> input,
+                                  std::size_t &consumed);
+
+/*
+ *  TranscodeSignedToCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      signed integers serialized by Serialize() into the same sequence of
+ *      integers serialized as CBOR major type 0 or 1 data items.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeSignedToCBOR(std::span<const std::uint8_t> input,
+                                  std::span<std::uint8_t> output,
+                                  std::size_t &consumed);
+
+/*
+ *  TranscodeSignedToCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeSignedToCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeSignedToCBORSize(std::span<const std::uint8_t> input,
+                                      std::size_t &consumed);
+
+/*
+ *  TranscodeSignedFromCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      CBOR major type 0 or 1 data items into the same sequence of
+ *      signed integers serialized as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Integers outside the range of std::int64_t and other data items
+ *      cannot be represented and result in an error.
+ */
+std::size_t TranscodeSignedFromCBOR(std::span<const std::uint8_t> input,
+                                    std::span<std::uint8_t> output,
+                                    std::size_t &consumed);
+
+/*
+ *  TranscodeSignedFromCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeSignedFromCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeSignedFromCBORSize(std::span<const std::uint8_t> input,
+                                        std::size_t &consumed);
+
+} // namespace VarIntEncoder
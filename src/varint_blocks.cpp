@@ -0,0 +1,595 @@
+/*
+ *  varint_blocks.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements functions that will serialize integers in
+ *      blocks, each described by a summary holding the minimum and maximum
+ *      values in the block, and that will use those summaries to find the
+ *      values within a range while deserializing only candidate blocks.
+ *
+ *      Each block is serialized and deserialized using the batch Serialize()
+ *      and Deserialize() functions, so the work is performed by the fastest
+ *      kernel supported by the processor.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "varint_encoder.h"
+#include "varint_blocks.h"
+
+namespace
+{
+
+// Maximum number of octets required to serialize a 64-bit integer
+constexpr std::size_t Max_Octets = 10;
+
+/*
+ *  EncodeBlocks()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer and
+ *      produce a summary of each block of values.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *      block_size [in]
+ *          The number of values in each block.
+ *
+ *      summaries [out]
+ *          The summaries of the blocks, which are appended to the vector.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the integers, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+std::size_t EncodeBlocks(
+    std::span<std::uint8_t> buffer,
+    std::span<const T> values,
+    std::size_t block_size,
+    std::vector<VarIntEncoder::BlockSummary<T>> &summaries)
+{
+    const std::size_t start = summaries.size();
+    std::size_t offset = 0;
+
+    if ((block_size == 0) || values.empty()) return 0;
+
+    for (std::size_t i = 0; i < values.size(); i += block_size)
+    {
+        std::span<const T> block =
+            values.subspan(i, std::min(block_size, values.size() - i));
+
+        // Determine the range of values in the block
+        T min = block[0];
+        T max = block[0];
+        for (T value : block)
+        {
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+
+        std::size_t length =
+            VarIntEncoder::Serialize(buffer.subspan(offset), block);
+        if (length == 0)
+        {
+            summaries.resize(start);
+            return 0;
+        }
+
+        summaries.push_back({min, max, block.size(), offset, length});
+        offset += length;
+    }
+
+    return offset;
+}
+
+/*
+ *  ScanBlocks()
+ *
+ *  Description:
+ *      This function will find the values in serialized data that lie
+ *      within the given range, skipping blocks that cannot hold them.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers.
+ *
+ *      summaries [in]
+ *          The summaries of the blocks in the serialized data.
+ *
+ *      low [in]
+ *          The smallest value to find.
+ *
+ *      high [in]
+ *          The largest value to find.
+ *
+ *      matches [out]
+ *          The values found, which are appended to the vector.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool ScanBlocks(std::span<const std::uint8_t> data,
+                std::span<const VarIntEncoder::BlockSummary<T>> summaries,
+                T low,
+                T high,
+                std::vector<T> &matches)
+{
+    std::vector<T> block;
+
+    for (const VarIntEncoder::BlockSummary<T> &summary : summaries)
+    {
+        // Skip blocks that cannot hold any value in the range
+        if ((summary.max < low) || (summary.min > high)) continue;
+
+        if ((summary.offset > data.size()) ||
+            (summary.length > data.size() - summary.offset))
+        {
+            return false;
+        }
+
+        std::span<const std::uint8_t> serialized =
+            data.subspan(summary.offset, summary.length);
+
+        // Every value in a block lying within the range is a match
+        if ((summary.min >= low) && (summary.max <= high))
+        {
+            const std::size_t first = matches.size();
+            matches.resize(first + summary.count);
+            std::span<T> values = std::span(matches).subspan(first);
+            if (VarIntEncoder::Deserialize(serialized, values) !=
+                summary.length)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // Otherwise, examine each value in the block
+        block.resize(summary.count);
+        if (VarIntEncoder::Deserialize(serialized, std::span(block)) !=
+            summary.length)
+        {
+            return false;
+        }
+
+        for (T value : block)
+        {
+            if ((value >= low) && (value <= high)) matches.push_back(value);
+        }
+    }
+
+    return true;
+}
+
+/*
+ *  EncodeSummaries()
+ *
+ *  Description:
+ *      This function will serialize the given block summaries.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the summaries.
+ *
+ *      summaries [in]
+ *          The summaries to serialize.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the summaries, or zero
+ *      if there was an error.
+ *
+ *  Comments:
+ *      The maximum is serialized as its (unsigned) difference from the
+ *      minimum, which is small for blocks of similar values.
+ */
+template<typename T>
+std::size_t EncodeSummaries(
+    std::span<std::uint8_t> buffer,
+    std::span<const VarIntEncoder::BlockSummary<T>> summaries)
+{
+    std::size_t offset = 0;
+    std::size_t data_offset = 0;
+
+    // Serialize the given value following those already serialized
+    auto Put = [&](auto value) -> bool
+    {
+        std::size_t length =
+            VarIntEncoder::Serialize(buffer.subspan(offset), value);
+        offset += length;
+        return length > 0;
+    };
+
+    if (!Put(std::uint64_t(summaries.size()))) return 0;
+
+    for (const VarIntEncoder::BlockSummary<T> &summary : summaries)
+    {
+        if ((summary.offset != data_offset) || (summary.min > summary.max))
+        {
+            return 0;
+        }
+
+        if (!Put(std::uint64_t(summary.count)) ||
+            !Put(std::uint64_t(summary.length)) ||
+            !Put(summary.min) ||
+            !Put(std::uint64_t(summary.max) - std::uint64_t(summary.min)))
+        {
+            return 0;
+        }
+
+        data_offset += summary.length;
+    }
+
+    return offset;
+}
+
+/*
+ *  DecodeSummaries()
+ *
+ *  Description:
+ *      This function will deserialize block summaries.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the summaries.
+ *
+ *      summaries [out]
+ *          The summaries read from the buffer, which are appended to the
+ *          vector.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer, or zero if there
+ *      was an error.
+ *
+ *  Comments:
+ *      Each summary is checked for consistency: the block must hold at
+ *      least one value, its length must be possible for the number of
+ *      values, and the maximum must not be less than the minimum.
+ */
+template<typename T>
+std::size_t DecodeSummaries(
+    std::span<const std::uint8_t> buffer,
+    std::vector<VarIntEncoder::BlockSummary<T>> &summaries)
+{
+    const std::size_t start = summaries.size();
+    std::size_t offset = 0;
+    std::size_t data_offset = 0;
+    std::uint64_t block_count;
+
+    // Deserialize the value following those already deserialized
+    auto Get = [&](auto &value) -> bool
+    {
+        std::size_t length =
+            VarIntEncoder::Deserialize(buffer.subspan(offset), value);
+        offset += length;
+        return length > 0;
+    };
+
+    if (!Get(block_count)) return 0;
+
+    for (std::uint64_t i = 0; i < block_count; i++)
+    {
+        std::uint64_t count;
+        std::uint64_t length;
+        std::uint64_t range;
+        T min;
+
+        if (!Get(count) || !Get(length) || !Get(min) || !Get(range) ||
+            (count == 0) || (length < count) ||
+            ((length - 1) / Max_Octets >= count))
+        {
+            summaries.resize(start);
+            return 0;
+        }
+
+        T max = T(std::uint64_t(min) + range);
+        if (max < min)
+        {
+            summaries.resize(start);
+            return 0;
+        }
+
+        summaries.push_back({min, max, count, data_offset, length});
+        data_offset += length;
+    }
+
+    return offset;
+}
+
+} // anonymous namespace
+
+namespace VarIntEncoder
+{
+
+/*
+ *  SerializeBlocks()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, and produce a summary of each block of values.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *      block_size [in]
+ *          The number of values in each block.  The final block may hold
+ *          fewer values.
+ *
+ *      summaries [out]
+ *          The summaries of the blocks, which are appended to the vector.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeBlocks(
+    std::span<std::uint8_t> buffer,
+    std::span<const std::uint64_t> values,
+    std::size_t block_size,
+    std::vector<BlockSummary<std::uint64_t>> &summaries)
+{
+    return EncodeBlocks(buffer, values, block_size, summaries);
+}
+
+/*
+ *  SerializeBlocks()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, and produce a summary of each block of values.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *      block_size [in]
+ *          The number of values in each block.  The final block may hold
+ *          fewer values.
+ *
+ *      summaries [out]
+ *          The summaries of the blocks, which are appended to the vector.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeBlocks(
+    std::span<std::uint8_t> buffer,
+    std::span<const std::int64_t> values,
+    std::size_t block_size,
+    std::vector<BlockSummary<std::int64_t>> &summaries)
+{
+    return EncodeBlocks(buffer, values, block_size, summaries);
+}
+
+/*
+ *  ScanRange()
+ *
+ *  Description:
+ *      This function will find the values in serialized data that lie
+ *      within the given range, deserializing only those blocks whose
+ *      summaries indicate they may hold such values.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers, as produced by SerializeBlocks().
+ *
+ *      summaries [in]
+ *          The summaries of the blocks in the serialized data.
+ *
+ *      low [in]
+ *          The smallest value to find.
+ *
+ *      high [in]
+ *          The largest value to find.
+ *
+ *      matches [out]
+ *          The values found, in order, which are appended to the vector.
+ *
+ *  Returns:
+ *      True if successful, false if a block deserialized was invalid or
+ *      lies outside of the data.
+ *
+ *  Comments:
+ *      None.
+ */
+bool ScanRange(std::span<const std::uint8_t> data,
+               std::span<const BlockSummary<std::uint64_t>> summaries,
+               std::uint64_t low,
+               std::uint64_t high,
+               std::vector<std::uint64_t> &matches)
+{
+    return ScanBlocks(data, summaries, low, high, matches);
+}
+
+/*
+ *  ScanRange()
+ *
+ *  Description:
+ *      This function will find the values in serialized data that lie
+ *      within the given range, deserializing only those blocks whose
+ *      summaries indicate they may hold such values.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers, as produced by SerializeBlocks().
+ *
+ *      summaries [in]
+ *          The summaries of the blocks in the serialized data.
+ *
+ *      low [in]
+ *          The smallest value to find.
+ *
+ *      high [in]
+ *          The largest value to find.
+ *
+ *      matches [out]
+ *          The values found, in order, which are appended to the vector.
+ *
+ *  Returns:
+ *      True if successful, false if a block deserialized was invalid or
+ *      lies outside of the data.
+ *
+ *  Comments:
+ *      None.
+ */
+bool ScanRange(std::span<const std::uint8_t> data,
+               std::span<const BlockSummary<std::int64_t>> summaries,
+               std::int64_t low,
+               std::int64_t high,
+               std::vector<std::int64_t> &matches)
+{
+    return ScanBlocks(data, summaries, low, high, matches);
+}
+
+/*
+ *  SerializeSummaries()
+ *
+ *  Description:
+ *      This function will serialize the given block summaries into the
+ *      buffer so they may be stored alongside the serialized data.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the summaries.
+ *
+ *      summaries [in]
+ *          The summaries to serialize.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the summaries, or zero
+ *      if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeSummaries(
+    std::span<std::uint8_t> buffer,
+    std::span<const BlockSummary<std::uint64_t>> summaries)
+{
+    return EncodeSummaries(buffer, summaries);
+}
+
+/*
+ *  DeserializeSummaries()
+ *
+ *  Description:
+ *      This function will deserialize block summaries serialized using
+ *      SerializeSummaries().
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the summaries.
+ *
+ *      summaries [out]
+ *          The summaries read from the buffer, which are appended to the
+ *          vector.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t DeserializeSummaries(
+    std::span<const std::uint8_t> buffer,
+    std::vector<BlockSummary<std::uint64_t>> &summaries)
+{
+    return DecodeSummaries(buffer, summaries);
+}
+
+/*
+ *  SerializeSummaries()
+ *
+ *  Description:
+ *      This function will serialize the given block summaries into the
+ *      buffer so they may be stored alongside the serialized data.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the summaries.
+ *
+ *      summaries [in]
+ *          The summaries to serialize.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the summaries, or zero
+ *      if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeSummaries(
+    std::span<std::uint8_t> buffer,
+    std::span<const BlockSummary<std::int64_t>> summaries)
+{
+    return EncodeSummaries(buffer, summaries);
+}
+
+/*
+ *  DeserializeSummaries()
+ *
+ *  Description:
+ *      This function will deserialize block summaries serialized using
+ *      SerializeSummaries().
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the summaries.
+ *
+ *      summaries [out]
+ *          The summaries read from the buffer, which are appended to the
+ *          vector.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t DeserializeSummaries(
+    std::span<const std::uint8_t> buffer,
+    std::vector<BlockSummary<std::int64_t>> &summaries)
+{
+    return DecodeSummaries(buffer, summaries);
+}
+
+} // namespace VarIntEncoder
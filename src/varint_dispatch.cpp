@@ -0,0 +1,724 @@
+/*
+ *  varint_dispatch.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements the functions that serialize or deserialize
+ *      many integers at once, dispatching to the kernel tier selected when
+ *      the first such function is called.  It also implements the scalar
+ *      kernel tier, which simply calls Serialize() or Deserialize() for
+ *      each integer.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <span>
+
+#include "varint_encoder.h"
+#include "varint_dispatch.h"
+#include "varint_kernels.h"
+
+namespace
+{
+
+using VarIntEncoder::KernelTier;
+using VarIntEncoder::Kernels::KernelTable;
+
+/*
+ *  SerializeScalar()
+ *
+ *  Description:
+ *      This function will serialize the given values by calling Serialize()
+ *      for each value.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the integers, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+std::size_t SerializeScalar(std::span<std::uint8_t> buffer,
+                            std::span<const T> values)
+{
+    std::size_t position{0};
+
+    for (T value : values)
+    {
+        std::size_t length =
+            VarIntEncoder::Serialize(buffer.subspan(position), value);
+        if (length == 0) return 0;
+        position += length;
+    }
+
+    return position;
+}
+
+/*
+ *  DeserializeScalar()
+ *
+ *  Description:
+ *      This function will deserialize the given number of values by calling
+ *      Deserialize() for each value.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+std::size_t DeserializeScalar(std::span<const std::uint8_t> buffer,
+                              std::span<T> values)
+{
+    std::size_t position{0};
+
+    for (T &value : values)
+    {
+        std::size_t length =
+            VarIntEncoder::Deserialize(buffer.subspan(position), value);
+        if (length == 0) return 0;
+        position += length;
+    }
+
+    return position;
+}
+
+/*
+ *  GetKernelTable()
+ *
+ *  Description:
+ *      This function will return the table of kernel functions for the
+ *      given tier.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier.
+ *
+ *  Returns:
+ *      The table of kernel functions, or nullptr if the tier is not
+ *      supported by this processor.
+ *
+ *  Comments:
+ *      None.
+ */
+const KernelTable *GetKernelTable(KernelTier tier)
+{
+    switch (tier)
+    {
+        case KernelTier::Scalar:
+            return &VarIntEncoder::Kernels::Scalar_Kernels;
+
+        case KernelTier::AVX512:
+#ifdef VARINT_ENCODER_AVX512
+            if (VarIntEncoder::Kernels::AVX512Supported())
+            {
+                return &VarIntEncoder::Kernels::AVX512_Kernels;
+            }
+#endif
+            return nullptr;
+    }
+
+    return nullptr;
+}
+
+/*
+ *  SelectKernelTier()
+ *
+ *  Description:
+ *      This function will select the fastest kernel tier supported by this
+ *      processor, unless the VARINT_ENCODER_TIER environment variable names
+ *      a slower tier.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The selected kernel tier.
+ *
+ *  Comments:
+ *      None.
+ */
+KernelTier SelectKernelTier()
+{
+    KernelTier tier = KernelTier::Scalar;
+
+    // Select the fastest tier supported by the processor
+    for (KernelTier candidate : {KernelTier::AVX512})
+    {
+        if (GetKernelTable(candidate) != nullptr)
+        {
+            tier = candidate;
+            break;
+        }
+    }
+
+    // Allow the environment to force a lower tier
+    const char *name = std::getenv("VARINT_ENCODER_TIER");
+    if (name != nullptr)
+    {
+        for (KernelTier candidate : {KernelTier::Scalar, KernelTier::AVX512})
+        {
+            if ((std::strcmp(name, GetKernelTierName(candidate)) == 0) &&
+                (candidate < tier))
+            {
+                tier = candidate;
+            }
+        }
+    }
+
+    return tier;
+}
+
+// The kernel tier in use and its table of functions
+struct ActiveKernels
+{
+    std::atomic<KernelTier> tier;
+    std::atomic<const KernelTable *> table;
+
+    ActiveKernels() : tier(SelectKernelTier()), table(GetKernelTable(tier)) {}
+};
+
+/*
+ *  GetActiveKernels()
+ *
+ *  Description:
+ *      This function will return the state identifying the kernel tier in
+ *      use, selecting the tier on first use.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The kernel tier in use and its table of functions.
+ *
+ *  Comments:
+ *      None.
+ */
+ActiveKernels &GetActiveKernels()
+{
+    static ActiveKernels active_kernels;
+
+    return active_kernels;
+}
+
+/*
+ *  Active()
+ *
+ *  Description:
+ *      This function will return the table of kernel functions in use.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The table of kernel functions in use.
+ *
+ *  Comments:
+ *      None.
+ */
+inline const KernelTable &Active()
+{
+    return *GetActiveKernels().table.load(std::memory_order_relaxed);
+}
+
+#if defined(__SIZEOF_INT128__)
+
+// Number of 128-bit values handed to a 64-bit kernel at once
+constexpr std::size_t Wide_Group_Size = 64;
+
+/*
+ *  SerializeWide()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit values, handing runs
+ *      of values that fit within 64 bits to the 64-bit batch kernel.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the integers, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Wide is the 128-bit type and Narrow the 64-bit type of the same
+ *      signedness.  Since a value that fits within 64 bits serializes the
+ *      same way as either type, the output is unaffected by the grouping.
+ */
+template<typename Wide, typename Narrow>
+std::size_t SerializeWide(std::span<std::uint8_t> buffer,
+                          std::span<const Wide> values)
+{
+    Narrow narrow[Wide_Group_Size];
+    std::size_t position{0};
+    std::size_t i{0};
+
+    while (i < values.size())
+    {
+        std::size_t count{0};
+        std::size_t length;
+
+        // Gather a run of values that fit within 64 bits
+        while ((i + count < values.size()) && (count < Wide_Group_Size) &&
+               (static_cast<Narrow>(values[i + count]) == values[i + count]))
+        {
+            narrow[count] = static_cast<Narrow>(values[i + count]);
+            count++;
+        }
+
+        if (count > 0)
+        {
+            length = VarIntEncoder::Serialize(
+                buffer.subspan(position),
+                std::span<const Narrow>(narrow, count));
+        }
+        else
+        {
+            length = VarIntEncoder::Serialize(buffer.subspan(position),
+                                              values[i]);
+            count = 1;
+        }
+
+        if (length == 0) return 0;
+
+        position += length;
+        i += count;
+    }
+
+    return position;
+}
+
+/*
+ *  DeserializeWide()
+ *
+ *  Description:
+ *      This function will deserialize the given number of 128-bit values,
+ *      using the 64-bit batch kernel for each group of values that all fit
+ *      within 64 bits.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      A group is first deserialized by the 64-bit kernel.  If that fails,
+ *      either the group contains a value that requires more than 64 bits or
+ *      the data is invalid, so the group is deserialized again one value at
+ *      a time.  Any valid 64-bit encoding yields the same value when read as
+ *      a 128-bit integer, so the result is unaffected by the grouping.
+ */
+template<typename Wide, typename Narrow>
+std::size_t DeserializeWide(std::span<const std::uint8_t> buffer,
+                            std::span<Wide> values)
+{
+    Narrow narrow[Wide_Group_Size];
+    std::size_t position{0};
+    std::size_t i{0};
+
+    while (i < values.size())
+    {
+        std::size_t count = std::min(Wide_Group_Size, values.size() - i);
+
+        std::size_t length = VarIntEncoder::Deserialize(
+            buffer.subspan(position), std::span<Narrow>(narrow, count));
+
+        if (length > 0)
+        {
+            for (std::size_t j = 0; j < count; j++) values[i + j] = narrow[j];
+            position += length;
+            i += count;
+            continue;
+        }
+
+        // Deserialize the group one value at a time
+        for (std::size_t j = 0; j < count; j++, i++)
+        {
+            length = VarIntEncoder::Deserialize(buffer.subspan(position),
+                                                values[i]);
+            if (length == 0) return 0;
+            position += length;
+        }
+    }
+
+    return position;
+}
+
+#endif // __SIZEOF_INT128__
+
+} // anonymous namespace
+
+namespace VarIntEncoder
+{
+
+namespace Kernels
+{
+
+// The scalar tier, which is the reference for all other tiers
+const KernelTable Scalar_Kernels = {SerializeScalar<std::uint64_t>,
+                                    DeserializeScalar<std::uint64_t>,
+                                    SerializeScalar<std::int64_t>,
+                                    DeserializeScalar<std::int64_t>};
+
+} // namespace Kernels
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const std::uint64_t> values)
+{
+    return Active().serialize_unsigned(buffer, values);
+}
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length integers
+ *      encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<std::uint64_t> values)
+{
+    return Active().deserialize_unsigned(buffer, values);
+}
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const std::int64_t> values)
+{
+    return Active().serialize_signed(buffer, values);
+}
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length integers
+ *      encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<std::int64_t> values)
+{
+    return Active().deserialize_signed(buffer, values);
+}
+
+#if defined(__SIZEOF_INT128__)
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit values into the buffer,
+ *      one after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const uint128_t> values)
+{
+    return SerializeWide<uint128_t, std::uint64_t>(buffer, values);
+}
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of 128-bit variable-length
+ *      integers encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<uint128_t> values)
+{
+    return DeserializeWide<uint128_t, std::uint64_t>(buffer, values);
+}
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit values into the buffer,
+ *      one after another, using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integers, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::span<const int128_t> values)
+{
+    return SerializeWide<int128_t, std::int64_t>(buffer, values);
+}
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of 128-bit variable-length
+ *      integers encoded one after another in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        std::span<int128_t> values)
+{
+    return DeserializeWide<int128_t, std::int64_t>(buffer, values);
+}
+
+#endif // __SIZEOF_INT128__
+
+/*
+ *  GetKernelTier()
+ *
+ *  Description:
+ *      This function will return the kernel tier presently in use.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The kernel tier presently in use.
+ *
+ *  Comments:
+ *      None.
+ */
+KernelTier GetKernelTier()
+{
+    return GetActiveKernels().tier.load();
+}
+
+/*
+ *  SetKernelTier()
+ *
+ *  Description:
+ *      This function will select the kernel tier to use.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier to use.
+ *
+ *  Returns:
+ *      True if the tier was selected, false if the tier is not supported
+ *      by this processor.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SetKernelTier(KernelTier tier)
+{
+    const KernelTable *table = GetKernelTable(tier);
+
+    if (table == nullptr) return false;
+
+    ActiveKernels &active_kernels = GetActiveKernels();
+    active_kernels.table.store(table);
+    active_kernels.tier.store(tier);
+
+    return true;
+}
+
+/*
+ *  IsKernelTierSupported()
+ *
+ *  Description:
+ *      This function will determine whether the given kernel tier is
+ *      supported by this processor.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier in question.
+ *
+ *  Returns:
+ *      True if the tier is supported, false if not.
+ *
+ *  Comments:
+ *      None.
+ */
+bool IsKernelTierSupported(KernelTier tier)
+{
+    return GetKernelTable(tier) != nullptr;
+}
+
+/*
+ *  GetKernelTierName()
+ *
+ *  Description:
+ *      This function will return the name of the given kernel tier.
+ *
+ *  Parameters:
+ *      tier [in]
+ *          The kernel tier whose name is sought.
+ *
+ *  Returns:
+ *      The name of the kernel tier.
+ *
+ *  Comments:
+ *      None.
+ */
+const char *GetKernelTierName(KernelTier tier)
+{
+    switch (tier)
+    {
+        case KernelTier::Scalar:
+            return "scalar";
+
+        case KernelTier::AVX512:
+            return "avx512";
+    }
+
+    return "unknown";
+}
+
+} // namespace VarIntEncoder
@@ -21,12 +21,17 @@
  *      The '^' character marks the position of the bit indicating whether the
  *      next octet contains additional bits of the integer or not.
  *
+ *      LEB128 encoding uses the same octet count and continuation bit, but
+ *      orders the groups of 7 bits from least to most significant, so the
+ *      same size calculations serve both encodings.
+ *
  *  Portability Issues:
  *      None.
  */
 
 #include <cstdint>
 #include <cstddef>
+#include <algorithm>
 #include <span>
 
 #include "varint_encoder.h"
@@ -150,6 +155,112 @@ constexpr std::size_t VarIntSize(const std::int64_t &value)
     return (FindMSb(value) + 1) / 7 + 1;
 }
 
+#if defined(__SIZEOF_INT128__)
+
+using VarIntEncoder::uint128_t;
+using VarIntEncoder::int128_t;
+
+/*
+ *  FindMSb()
+ *
+ *  Description:
+ *      This function will find the most significant bit in the given 128-bit
+ *      unsigned integer.
+ *
+ *  Parameters:
+ *      v [in]
+ *          The value for which the most significant bit position is sought.
+ *
+ *  Returns:
+ *      The bit position having the most significant bit set to 1, with the
+ *      range being 0 to 127.  If the integer has a 0 value, this function
+ *      will return 0.
+ *
+ *  Comments:
+ *      None.
+ */
+constexpr std::size_t FindMSb(uint128_t v)
+{
+    const std::uint64_t high = static_cast<std::uint64_t>(v >> 64);
+
+    return ((high != 0) ? 64 + FindMSb(high) :
+                          FindMSb(static_cast<std::uint64_t>(v)));
+}
+
+/*
+ *  FindMSb()
+ *
+ *  Description:
+ *      This function will find the most significant bit in the given 128-bit
+ *      signed integer.  See the 64-bit signed form of this function for an
+ *      explanation of how negative values are treated.
+ *
+ *  Parameters:
+ *      v [in]
+ *          The value for which the most significant bit position is sought.
+ *
+ *  Returns:
+ *      The bit position having the most significant bit set to 0 or 1,
+ *      depending on whether the integer is negative or non-negative.  A
+ *      value of -1, 0, or 1 will all return 0.
+ *
+ *  Comments:
+ *      None.
+ */
+constexpr std::size_t FindMSb(int128_t v)
+{
+    return ((v >= 0) ? FindMSb(static_cast<uint128_t>(v)) :
+                       FindMSb(static_cast<uint128_t>(~v)));
+}
+
+/*
+ *  VarUintSize()
+ *
+ *  Description:
+ *      This function will return the number of octets required to encode
+ *      the given 128-bit variable-width unsigned integer.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value of the variable width unsigned integer.
+ *
+ *  Returns:
+ *      The number of octets required to encode the given variable-width
+ *      integer.
+ *
+ *  Comments:
+ *      None.
+ */
+constexpr std::size_t VarUintSize(const uint128_t value)
+{
+    return FindMSb(value) / 7 + 1;
+}
+
+/*
+ *  VarIntSize()
+ *
+ *  Description:
+ *      This function will return the number of octets required to encode
+ *      the given 128-bit variable-width signed integer.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value of the variable width signed integer.
+ *
+ *  Returns:
+ *      The number of octets required to encode the given variable-width
+ *      integer.
+ *
+ *  Comments:
+ *      None.
+ */
+constexpr std::size_t VarIntSize(const int128_t value)
+{
+    return (FindMSb(value) + 1) / 7 + 1;
+}
+
+#endif // __SIZEOF_INT128__
+
 } // anonymous namespace
 
 namespace VarIntEncoder
@@ -177,9 +288,45 @@ namespace VarIntEncoder
  *      None.
  */
 std::size_t Serialize(std::span<std::uint8_t> buffer, std::uint64_t value)
+{
+    return Serialize(buffer, value, 1);
+}
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      variable-length integer encoding, occupying at least the given
+ *      number of octets.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *      min_octets [in]
+ *          The minimum number of octets to occupy, which may not exceed 10.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      The integer is padded with leading 0x80 octets as required.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::uint64_t value,
+                      std::size_t min_octets)
 {
     // Determine space requirements for the variable-width integer
-    const std::size_t octets_required = VarUintSize(value);
+    const std::size_t octets_required =
+        std::max(VarUintSize(value), min_octets);
+
+    // A 64-bit value may not occupy more than 10 octets
+    if (octets_required > 10) return 0;
 
     // Ensure the buffer is of sufficient length
     if (buffer.size() < octets_required) return 0;
@@ -224,7 +371,7 @@ std::size_t Serialize(std::span<std::uint8_t> buffer, std::uint64_t value)
  *  Comments:
  *      None.
  */
-std::size_t Deserialize(const std::span<std::uint8_t> buffer,
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
                         std::uint64_t &value)
 {
     std::uint8_t octet{0x80};
@@ -249,8 +396,11 @@ std::size_t Deserialize(const std::span<std::uint8_t> buffer,
         value = (value << 7) | (octet & 0x7f);
     }
 
-    // If the total length is 10 octets, initial octet must be 0x81
-    if ((total_octets == 10) && (buffer[0] != 0x81)) return 0;
+    // If the total length is 10 octets, initial octet must be 0x80 or 0x81
+    if ((total_octets == 10) && (buffer[0] != 0x80) && (buffer[0] != 0x81))
+    {
+        return 0;
+    }
 
     return total_octets;
 }
@@ -277,9 +427,45 @@ std::size_t Deserialize(const std::span<std::uint8_t> buffer,
  *      None.
  */
 std::size_t Serialize(std::span<std::uint8_t> buffer, std::int64_t value)
+{
+    return Serialize(buffer, value, 1);
+}
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      variable-length integer encoding, occupying at least the given
+ *      number of octets.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *      min_octets [in]
+ *          The minimum number of octets to occupy, which may not exceed 10.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      The integer is padded with leading 0x80 octets if non-negative or
+ *      0xff octets if negative, as required.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer,
+                      std::int64_t value,
+                      std::size_t min_octets)
 {
     // Determine space requirements for the variable-width integer
-    std::size_t octets_required = VarIntSize(value);
+    std::size_t octets_required = std::max(VarIntSize(value), min_octets);
+
+    // A 64-bit value may not occupy more than 10 octets
+    if (octets_required > 10) return 0;
 
     // Ensure there is sufficient space in the buffer
     if (octets_required > buffer.size()) return 0;
@@ -324,7 +510,7 @@ std::size_t Serialize(std::span<std::uint8_t> buffer, std::int64_t value)
  *  Comments:
  *      None.
  */
-std::size_t Deserialize(const std::span<std::uint8_t> buffer,
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
                         std::int64_t &value)
 {
     std::uint8_t octet{0x80};
@@ -362,4 +548,542 @@ std::size_t Deserialize(const std::span<std::uint8_t> buffer,
     return total_octets;
 }
 
+/*
+ *  Rewrite()
+ *
+ *  Description:
+ *      This function will replace the variable-length integer encoded at the
+ *      start of the given buffer with the given value, occupying exactly the
+ *      same number of octets.
+ *
+ *  Parameters:
+ *      buffer [in/out]
+ *          The buffer holding the integer to replace.
+ *
+ *      value [in]
+ *          The value to write in place of the existing integer.
+ *
+ *  Returns:
+ *      The number of octets occupied by the integer, or zero if the buffer
+ *      does not begin with a valid integer or the value does not fit in the
+ *      octets occupied by the existing integer.  The buffer is not modified
+ *      if zero is returned.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Rewrite(std::span<std::uint8_t> buffer, std::uint64_t value)
+{
+    std::uint64_t existing;
+
+    // Determine the number of octets occupied by the existing integer
+    const std::size_t octets = Deserialize(buffer, existing);
+    if ((octets == 0) || (VarUintSize(value) > octets)) return 0;
+
+    return Serialize(buffer.first(octets), value, octets);
+}
+
+/*
+ *  Rewrite()
+ *
+ *  Description:
+ *      This function will replace the variable-length integer encoded at the
+ *      start of the given buffer with the given value, occupying exactly the
+ *      same number of octets.
+ *
+ *  Parameters:
+ *      buffer [in/out]
+ *          The buffer holding the integer to replace.
+ *
+ *      value [in]
+ *          The value to write in place of the existing integer.
+ *
+ *  Returns:
+ *      The number of octets occupied by the integer, or zero if the buffer
+ *      does not begin with a valid integer or the value does not fit in the
+ *      octets occupied by the existing integer.  The buffer is not modified
+ *      if zero is returned.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Rewrite(std::span<std::uint8_t> buffer, std::int64_t value)
+{
+    std::int64_t existing;
+
+    // Determine the number of octets occupied by the existing integer
+    const std::size_t octets = Deserialize(buffer, existing);
+    if ((octets == 0) || (VarIntSize(value) > octets)) return 0;
+
+    return Serialize(buffer.first(octets), value, octets);
+}
+
+/*
+ *  SerializeLEB128()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      unsigned LEB128 encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeLEB128(std::span<std::uint8_t> buffer,
+                            std::uint64_t value)
+{
+    // Determine space requirements for the variable-width integer
+    const std::size_t octets_required = VarUintSize(value);
+
+    // Ensure the buffer is of sufficient length
+    if (buffer.size() < octets_required) return 0;
+
+    // Write octets from left to right (least significant group first)
+    for (std::size_t i = 0; i < octets_required; i++)
+    {
+        // Get the group of 7 bits
+        std::uint8_t octet = value & 0x7f;
+
+        // Shift the data bits vector by 7 bits
+        value >>= 7;
+
+        // If this is not the last octet, set the MSb to 1
+        if (i != octets_required - 1) octet |= 0x80;
+
+        // Write the value into the buffer
+        buffer[i] = octet;
+    }
+
+    return octets_required;
+}
+
+/*
+ *  DeserializeLEB128()
+ *
+ *  Description:
+ *      This function will deserialize the unsigned LEB128 integer that is
+ *      encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t DeserializeLEB128(std::span<const std::uint8_t> buffer,
+                              std::uint64_t &value)
+{
+    std::uint8_t octet{0x80};
+    std::size_t total_octets{0};
+
+    // Initialize the integer value
+    value = 0;
+
+    // Read octets until we find the last one having a 0 MSb
+    while (octet & 0x80)
+    {
+        // A 64-bits value should never require more than 10 octets
+        if (++total_octets == 11) return 0;
+
+        // Ensure we do not read beyond the buffer
+        if (total_octets > buffer.size()) return 0;
+
+        // Get the target octet
+        octet = buffer[total_octets - 1];
+
+        // Add these bits to the returned value
+        value |= static_cast<std::uint64_t>(octet & 0x7f) <<
+                 (7 * (total_octets - 1));
+    }
+
+    // If the total length is 10 octets, final octet may only carry bit 63
+    if ((total_octets == 10) && (buffer[9] > 0x01)) return 0;
+
+    return total_octets;
+}
+
+/*
+ *  SerializeLEB128()
+ *
+ *  Description:
+ *      This function will serialize the given value into the buffer using
+ *      signed LEB128 encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SerializeLEB128(std::span<std::uint8_t> buffer,
+                            std::int64_t value)
+{
+    // Determine space requirements for the variable-width integer
+    const std::size_t octets_required = VarIntSize(value);
+
+    // Ensure there is sufficient space in the buffer
+    if (octets_required > buffer.size()) return 0;
+
+    // Write octets from left to right (least significant group first)
+    for (std::size_t i = 0; i < octets_required; i++)
+    {
+        // Get the group of 7 bits
+        std::uint8_t octet = value & 0x7f;
+
+        // Shift the data bits vector by 7 bits
+        value >>= 7;
+
+        // If this is not the last octet, set the MSb to 1
+        if (i != octets_required - 1) octet |= 0x80;
+
+        // Write the value into the buffer
+        buffer[i] = octet;
+    }
+
+    return octets_required;
+}
+
+/*
+ *  DeserializeLEB128()
+ *
+ *  Description:
+ *      This function will deserialize the signed LEB128 integer that is
+ *      encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t DeserializeLEB128(std::span<const std::uint8_t> buffer,
+                              std::int64_t &value)
+{
+    std::uint8_t octet{0x80};
+    std::size_t total_octets{0};
+    std::uint64_t bits{0};
+
+    // Read octets until we find the last one having a 0 MSb
+    while (octet & 0x80)
+    {
+        // A 64-bits value should never require more than 10 octets
+        if (++total_octets == 11) return 0;
+
+        // Ensure we do not read beyond the buffer
+        if (total_octets > buffer.size()) return 0;
+
+        // Get the target octet
+        octet = buffer[total_octets - 1];
+
+        // Add these bits to the returned value
+        bits |= static_cast<std::uint64_t>(octet & 0x7f) <<
+                (7 * (total_octets - 1));
+    }
+
+    // If the total length is 10 octets, ensure the final octet is one
+    // of the only two valid values
+    if ((total_octets == 10) && (octet != 0x00) && (octet != 0x7f)) return 0;
+
+    // Extend the sign bit of the final octet through the remaining bits
+    if ((total_octets < 10) && (octet & 0x40))
+    {
+        bits |= ~std::uint64_t(0) << (7 * total_octets);
+    }
+
+    value = static_cast<std::int64_t>(bits);
+
+    return total_octets;
+}
+
+#if defined(__SIZEOF_INT128__)
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit value into the buffer
+ *      using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width unsigned
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer, uint128_t value)
+{
+    // Values that fit in 64 bits are serialized using 64-bit arithmetic
+    if ((value >> 64) == 0)
+    {
+        return Serialize(buffer, static_cast<std::uint64_t>(value));
+    }
+
+    // Determine space requirements for the variable-width integer
+    const std::size_t octets_required = VarUintSize(value);
+
+    // Ensure the buffer is of sufficient length
+    if (buffer.size() < octets_required) return 0;
+
+    // Write octets from right to left (reverse order)
+    for (std::size_t i = octets_required; i > 0; i--)
+    {
+        // Get the group of 7 bits
+        std::uint8_t octet = value & 0x7f;
+
+        // Shift the data bits vector by 7 bits
+        value >>= 7;
+
+        // If this is not the last octet, set the MSb to 1
+        if (i != octets_required) octet |= 0x80;
+
+        // Write the value into the buffer
+        buffer[i - 1] = octet;
+    }
+
+    return octets_required;
+}
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize the 128-bit variable-length integer
+ *      that is encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      The first 9 octets (63 bits) are accumulated using 64-bit arithmetic,
+ *      as most values do not require more.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        uint128_t &value)
+{
+    std::uint8_t octet{0x80};
+    std::size_t total_octets{0};
+    std::uint64_t low{0};
+
+    // Read up to 9 octets until we find the last one having a 0 MSb
+    while ((octet & 0x80) && (total_octets < 9))
+    {
+        // Ensure we do not read beyond the buffer
+        if (++total_octets > buffer.size()) return 0;
+
+        // Get the target octet
+        octet = buffer[total_octets - 1];
+
+        // Add these bits to the returned value
+        low = (low << 7) | (octet & 0x7f);
+    }
+
+    value = low;
+
+    // Read any remaining octets using 128-bit arithmetic
+    while (octet & 0x80)
+    {
+        // A 128-bits value should never require more than 19 octets
+        if (++total_octets == 20) return 0;
+
+        // Ensure we do not read beyond the buffer
+        if (total_octets > buffer.size()) return 0;
+
+        // Get the target octet
+        octet = buffer[total_octets - 1];
+
+        // Add these bits to the returned value
+        value = (value << 7) | (octet & 0x7f);
+    }
+
+    // If the total length is 19 octets, initial octet must be 0x80 .. 0x83
+    if ((total_octets == 19) && (buffer[0] > 0x83))
+    {
+        return 0;
+    }
+
+    return total_octets;
+}
+
+/*
+ *  Serialize()
+ *
+ *  Description:
+ *      This function will serialize the given 128-bit value into the buffer
+ *      using variable-length integer encoding.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integer.
+ *
+ *      value [in]
+ *          The value to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the variable-width signed
+ *      integer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t Serialize(std::span<std::uint8_t> buffer, int128_t value)
+{
+    // Values that fit in 64 bits are serialized using 64-bit arithmetic
+    if (value == static_cast<std::int64_t>(value))
+    {
+        return Serialize(buffer, static_cast<std::int64_t>(value));
+    }
+
+    // Determine space requirements for the variable-width integer
+    std::size_t octets_required = VarIntSize(value);
+
+    // Ensure there is sufficient space in the buffer
+    if (octets_required > buffer.size()) return 0;
+
+    // Write octets from right to left (reverse order)
+    for (std::size_t i = octets_required; i > 0; i--)
+    {
+        // Get the group of 7 bits
+        std::uint8_t octet = value & 0x7f;
+
+        // Shift the data bits vector by 7 bits
+        value >>= 7;
+
+        // If this is not the last octet, set the MSb to 1
+        if (i != octets_required) octet |= 0x80;
+
+        // Write the value into the buffer
+        buffer[i - 1] = octet;
+    }
+
+    return octets_required;
+}
+
+/*
+ *  Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize the 128-bit variable-length integer
+ *      that is encoded in the given buffer.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integer.
+ *
+ *      value [out]
+ *          The value read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      The first 9 octets (63 bits plus the sign) are accumulated using
+ *      64-bit arithmetic, as most values do not require more.
+ */
+std::size_t Deserialize(std::span<const std::uint8_t> buffer,
+                        int128_t &value)
+{
+    std::uint8_t octet{0x80};
+    std::size_t total_octets{0};
+
+    // Ensure we do not read beyond the buffer
+    if (buffer.empty()) return 0;
+
+    // Determine the sign of the number by inspecting the leading sign bit
+    std::int64_t low = (buffer[0] & 0x40) ? -1 : 0;
+
+    // Read up to 9 octets until we find the last one having a 0 MSb
+    while ((octet & 0x80) && (total_octets < 9))
+    {
+        // Ensure we do not read beyond the buffer
+        if (++total_octets > buffer.size()) return 0;
+
+        // Get the target octet
+        octet = buffer[total_octets - 1];
+
+        // Add these bits to the returned value
+        low = (low << 7) | (octet & 0x7f);
+    }
+
+    value = low;
+
+    // Read any remaining octets using 128-bit arithmetic
+    while (octet & 0x80)
+    {
+        // A 128-bits value should never require more than 19 octets
+        if (++total_octets == 20) return 0;
+
+        // Ensure we do not read beyond the buffer
+        if (total_octets > buffer.size()) return 0;
+
+        // Get the target octet
+        octet = buffer[total_octets - 1];
+
+        // Add these bits to the returned value
+        value = (value << 7) | (octet & 0x7f);
+    }
+
+    // If the total length is 19 octets, ensure the initial octet is one
+    // of the only four valid values
+    if ((total_octets == 19) && (buffer[0] != 0x80) && (buffer[0] != 0x81) &&
+        (buffer[0] != 0xfe) && (buffer[0] != 0xff))
+    {
+        return 0;
+    }
+
+    return total_octets;
+}
+
+#endif // __SIZEOF_INT128__
+
 } // namespace VarIntEncoder
@@ -0,0 +1,54 @@
+/*
+ *  varint_kernels.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module defines the table of kernel functions used to serialize
+ *      and deserialize many integers at once, along with the table for
+ *      each kernel tier built into the library.  This is an internal
+ *      header and is not installed.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// The AVX-512 tier relies on GCC/Clang function-level target attributes
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define VARINT_ENCODER_AVX512 1
+#endif
+
+namespace VarIntEncoder::Kernels
+{
+
+// Functions implementing a kernel tier
+struct KernelTable
+{
+    std::size_t (*serialize_unsigned)(std::span<std::uint8_t> buffer,
+                                      std::span<const std::uint64_t> values);
+    std::size_t (*deserialize_unsigned)(std::span<const std::uint8_t> buffer,
+                                        std::span<std::uint64_t> values);
+    std::size_t (*serialize_signed)(std::span<std::uint8_t> buffer,
+                                    std::span<const std::int64_t> values);
+    std::size_t (*deserialize_signed)(std::span<const std::uint8_t> buffer,
+                                      std::span<std::int64_t> values);
+};
+
+extern const KernelTable Scalar_Kernels;
+
+#ifdef VARINT_ENCODER_AVX512
+extern const KernelTable AVX512_Kernels;
+
+bool AVX512Supported();
+#endif
+
+} // namespace VarIntEncoder::Kernels
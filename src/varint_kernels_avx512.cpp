@@ -0,0 +1,406 @@
+/*
+ *  varint_kernels_avx512.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements the AVX-512 kernel tier, which serializes or
+ *      deserializes eight integers at a time using 512-bit registers.
+ *
+ *      To deserialize, 64 octets are loaded and the octets having a zero
+ *      MSb mark the end of each integer.  Given the position and length of
+ *      the next eight integers, a single vpermb places the octets of each
+ *      integer into its own 64-bit lane in reverse order (least significant
+ *      group first), after which the groups of 7 bits are packed together
+ *      using three shift-and-merge steps.
+ *
+ *      To serialize, the process is reversed: the groups of 7 bits of each
+ *      integer are spread into separate octets, continuation bits are set,
+ *      vpermb reverses the octets within each lane, and vpcompressb packs
+ *      the octets of all eight integers together for a single store.
+ *
+ *      Integers requiring more than 8 octets (i.e., more than 56 bits)
+ *      are handled by Serialize() and Deserialize(), which also handle the
+ *      final few integers in a buffer.
+ *
+ *  Portability Issues:
+ *      The functions in this module must only be called on processors
+ *      supporting AVX-512 F, BW, CD, VBMI, and VBMI2.  The module is built
+ *      without special compiler options, relying on function-level target
+ *      attributes, so it may be safely linked into programs that run on
+ *      any x86 processor.
+ */
+
+#include "varint_kernels.h"
+
+#ifdef VARINT_ENCODER_AVX512
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <span>
+#include <type_traits>
+#include <immintrin.h>
+
+#include "varint_encoder.h"
+
+// GCC reports the deliberately undefined registers used within some AVX-512
+// intrinsics (e.g., _mm512_undefined_epi32()) as possibly uninitialized, so
+// that warning is suppressed around the statements using those intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#define VARINT_ENCODER_UNDEFINED_BEGIN \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define VARINT_ENCODER_UNDEFINED_END _Pragma("GCC diagnostic pop")
+#else
+#define VARINT_ENCODER_UNDEFINED_BEGIN
+#define VARINT_ENCODER_UNDEFINED_END
+#endif
+
+#define VARINT_ENCODER_TARGET_AVX512 \
+    __attribute__((target("avx512f,avx512bw,avx512cd,avx512vbmi,avx512vbmi2")))
+
+namespace
+{
+
+/*
+ *  SerializeAVX512()
+ *
+ *  Description:
+ *      This function will serialize the given values into the buffer, one
+ *      after another, eight values at a time.
+ *
+ *  Parameters:
+ *      buffer [out]
+ *          The buffer into which to serialize the integers.
+ *
+ *      values [in]
+ *          The values to insert into the data buffer.
+ *
+ *  Returns:
+ *      The number of octets required to serialize the integers, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Octets in the buffer beyond those serialized are not modified.
+ */
+template<typename T>
+VARINT_ENCODER_TARGET_AVX512
+std::size_t SerializeAVX512(std::span<std::uint8_t> buffer,
+                            std::span<const T> values)
+{
+    std::uint8_t *out = buffer.data();
+    const std::size_t size = buffer.size();
+    const std::size_t count = values.size();
+    std::size_t position{0};
+    std::size_t i{0};
+
+    // Index of each octet within its 64-bit lane
+    const __m512i octet_index = _mm512_set1_epi64(0x0706050403020100);
+
+    // Index of the first octet of each 64-bit lane
+    const __m512i lane_base = _mm512_set_epi64(0x3838383838383838,
+                                               0x3030303030303030,
+                                               0x2828282828282828,
+                                               0x2020202020202020,
+                                               0x1818181818181818,
+                                               0x1010101010101010,
+                                               0x0808080808080808,
+                                               0x0000000000000000);
+
+    // Shuffle replicating the low octet of each lane across the lane
+    const __m512i replicate = _mm512_set_epi64(0x0808080808080808,
+                                               0x0000000000000000,
+                                               0x0808080808080808,
+                                               0x0000000000000000,
+                                               0x0808080808080808,
+                                               0x0000000000000000,
+                                               0x0808080808080808,
+                                               0x0000000000000000);
+
+    while ((count - i >= 8) && (size - position >= 64))
+    {
+        __m512i v = _mm512_loadu_si512(values.data() + i);
+        __m512i bits;
+
+        VARINT_ENCODER_UNDEFINED_BEGIN
+
+        // Determine the number of significant bits in each value
+        if constexpr (std::is_signed_v<T>)
+        {
+            __m512i magnitude = _mm512_xor_si512(v, _mm512_srai_epi64(v, 63));
+            bits = _mm512_sub_epi64(_mm512_set1_epi64(65),
+                                    _mm512_lzcnt_epi64(magnitude));
+        }
+        else
+        {
+            bits = _mm512_max_epu64(
+                _mm512_sub_epi64(_mm512_set1_epi64(64), _mm512_lzcnt_epi64(v)),
+                _mm512_set1_epi64(1));
+        }
+
+        // Octets required is (bits + 6) / 7, i.e., ((bits + 6) * 37) >> 8
+        __m512i lengths = _mm512_srli_epi64(
+            _mm512_mul_epu32(_mm512_add_epi64(bits, _mm512_set1_epi64(6)),
+                             _mm512_set1_epi64(37)),
+            8);
+
+        VARINT_ENCODER_UNDEFINED_END
+
+        // Values requiring more than 8 octets are serialized individually
+        if (_mm512_cmpgt_epu64_mask(lengths, _mm512_set1_epi64(8)))
+        {
+            for (std::size_t j = 0; j < 8; j++, i++)
+            {
+                std::size_t length =
+                    VarIntEncoder::Serialize(buffer.subspan(position),
+                                             values[i]);
+                if (length == 0) return 0;
+                position += length;
+            }
+            continue;
+        }
+
+        VARINT_ENCODER_UNDEFINED_BEGIN
+
+        // Spread the groups of 7 bits into separate octets
+        __m512i x = _mm512_or_si512(
+            _mm512_and_si512(v, _mm512_set1_epi64(0x000000000fffffff)),
+            _mm512_and_si512(_mm512_slli_epi64(v, 4),
+                             _mm512_set1_epi64(0x0fffffff00000000)));
+        x = _mm512_or_si512(
+            _mm512_and_si512(x, _mm512_set1_epi64(0x00003fff00003fff)),
+            _mm512_and_si512(_mm512_slli_epi64(x, 2),
+                             _mm512_set1_epi64(0x3fff00003fff0000)));
+        x = _mm512_or_si512(
+            _mm512_and_si512(x, _mm512_set1_epi64(0x007f007f007f007f)),
+            _mm512_and_si512(_mm512_slli_epi64(x, 1),
+                             _mm512_set1_epi64(0x7f007f007f007f00)));
+
+        // Mark the octets of each value and set the continuation bits
+        __m512i length_octets = _mm512_shuffle_epi8(lengths, replicate);
+        __mmask64 valid = _mm512_cmplt_epu8_mask(octet_index, length_octets);
+        __mmask64 continuation = valid & 0xfefefefefefefefe;
+        x = _mm512_or_si512(
+            x,
+            _mm512_maskz_mov_epi8(continuation, _mm512_set1_epi8(-128)));
+
+        // Reverse the octets of each value within its lane
+        __m512i index = _mm512_add_epi8(
+            lane_base,
+            _mm512_sub_epi8(
+                _mm512_sub_epi8(length_octets, _mm512_set1_epi8(1)),
+                octet_index));
+        x = _mm512_permutexvar_epi8(index, x);
+
+        VARINT_ENCODER_UNDEFINED_END
+
+        // Pack the octets of all values together and store them
+        x = _mm512_maskz_compress_epi8(valid, x);
+        std::size_t total = std::popcount(valid);
+        __mmask64 store_mask =
+            (total == 64) ? ~__mmask64(0) : ((__mmask64(1) << total) - 1);
+        _mm512_mask_storeu_epi8(out + position, store_mask, x);
+
+        position += total;
+        i += 8;
+    }
+
+    // Serialize any remaining values individually
+    for (; i < count; i++)
+    {
+        std::size_t length =
+            VarIntEncoder::Serialize(buffer.subspan(position), values[i]);
+        if (length == 0) return 0;
+        position += length;
+    }
+
+    return position;
+}
+
+/*
+ *  DeserializeAVX512()
+ *
+ *  Description:
+ *      This function will deserialize the given number of values from the
+ *      buffer, eight values at a time.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The buffer from which to deserialize the integers.
+ *
+ *      values [out]
+ *          The values read from the buffer.
+ *
+ *  Returns:
+ *      The number of octets deserialized from the buffer.  A zero indicates
+ *      there was a deserialization error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+VARINT_ENCODER_TARGET_AVX512
+std::size_t DeserializeAVX512(std::span<const std::uint8_t> buffer,
+                              std::span<T> values)
+{
+    const std::uint8_t *in = buffer.data();
+    const std::size_t size = buffer.size();
+    const std::size_t count = values.size();
+    std::size_t position{0};
+    std::size_t i{0};
+
+    // Index of each octet within its 64-bit lane
+    const __m512i octet_index = _mm512_set1_epi64(0x0706050403020100);
+
+    // Shuffle replicating the low octet of each lane across the lane
+    const __m512i replicate = _mm512_set_epi64(0x0808080808080808,
+                                               0x0000000000000000,
+                                               0x0808080808080808,
+                                               0x0000000000000000,
+                                               0x0808080808080808,
+                                               0x0000000000000000,
+                                               0x0808080808080808,
+                                               0x0000000000000000);
+
+    while ((count - i >= 8) && (size - position >= 64))
+    {
+        __m512i data = _mm512_loadu_si512(in + position);
+        std::uint64_t terminators = ~_mm512_movepi8_mask(data);
+        alignas(64) std::uint64_t ends[8];
+        alignas(64) std::uint64_t lengths[8];
+        std::size_t start{0};
+        std::size_t j{0};
+
+        // Locate the final octet of each of the next eight integers
+        for (; j < 8; j++)
+        {
+            if (terminators == 0) break;
+
+            std::size_t end = std::countr_zero(terminators);
+            terminators &= terminators - 1;
+
+            if (end - start >= 8) break;
+
+            ends[j] = end;
+            lengths[j] = end - start + 1;
+            start = end + 1;
+        }
+
+        // Values requiring more than 8 octets are deserialized individually
+        if (j < 8)
+        {
+            std::size_t length =
+                VarIntEncoder::Deserialize(buffer.subspan(position),
+                                           values[i]);
+            if (length == 0) return 0;
+            position += length;
+            i++;
+            continue;
+        }
+
+        // Gather the octets of each value into its lane in reverse order
+        __m512i length_vector = _mm512_load_si512(lengths);
+        __m512i end_octets =
+            _mm512_shuffle_epi8(_mm512_load_si512(ends), replicate);
+        __mmask64 valid = _mm512_cmplt_epu8_mask(
+            octet_index,
+            _mm512_shuffle_epi8(length_vector, replicate));
+        __m512i x = _mm512_maskz_permutexvar_epi8(
+            valid,
+            _mm512_sub_epi8(end_octets, octet_index),
+            data);
+
+        VARINT_ENCODER_UNDEFINED_BEGIN
+
+        // Pack the groups of 7 bits together
+        x = _mm512_and_si512(x, _mm512_set1_epi8(0x7f));
+        x = _mm512_or_si512(
+            _mm512_and_si512(x, _mm512_set1_epi64(0x007f007f007f007f)),
+            _mm512_srli_epi64(
+                _mm512_and_si512(x, _mm512_set1_epi64(0x7f007f007f007f00)),
+                1));
+        x = _mm512_or_si512(
+            _mm512_and_si512(x, _mm512_set1_epi64(0x00003fff00003fff)),
+            _mm512_srli_epi64(
+                _mm512_and_si512(x, _mm512_set1_epi64(0x3fff00003fff0000)),
+                2));
+        x = _mm512_or_si512(
+            _mm512_and_si512(x, _mm512_set1_epi64(0x000000000fffffff)),
+            _mm512_srli_epi64(
+                _mm512_and_si512(x, _mm512_set1_epi64(0x0fffffff00000000)),
+                4));
+
+        // Extend the sign bit of signed values
+        if constexpr (std::is_signed_v<T>)
+        {
+            __m512i shift = _mm512_sub_epi64(
+                _mm512_set1_epi64(64),
+                _mm512_sub_epi64(_mm512_slli_epi64(length_vector, 3),
+                                 length_vector));
+            x = _mm512_srav_epi64(_mm512_sllv_epi64(x, shift), shift);
+        }
+
+        VARINT_ENCODER_UNDEFINED_END
+
+        _mm512_storeu_si512(values.data() + i, x);
+
+        position += start;
+        i += 8;
+    }
+
+    // Deserialize any remaining values individually
+    for (; i < count; i++)
+    {
+        std::size_t length =
+            VarIntEncoder::Deserialize(buffer.subspan(position), values[i]);
+        if (length == 0) return 0;
+        position += length;
+    }
+
+    return position;
+}
+
+} // anonymous namespace
+
+namespace VarIntEncoder::Kernels
+{
+
+// The AVX-512 tier
+const KernelTable AVX512_Kernels = {SerializeAVX512<std::uint64_t>,
+                                    DeserializeAVX512<std::uint64_t>,
+                                    SerializeAVX512<std::int64_t>,
+                                    DeserializeAVX512<std::int64_t>};
+
+/*
+ *  AVX512Supported()
+ *
+ *  Description:
+ *      This function will determine whether the processor and operating
+ *      system support the AVX-512 instructions used by this tier.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if the AVX-512 tier may be used, false if not.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AVX512Supported()
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512bw") &&
+           __builtin_cpu_supports("avx512cd") &&
+           __builtin_cpu_supports("avx512vbmi") &&
+           __builtin_cpu_supports("avx512vbmi2");
+}
+
+} // namespace VarIntEncoder::Kernels
+
+#endif // VARINT_ENCODER_AVX512
@@ -0,0 +1,944 @@
+/*
+ *  varint_ring.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements the SharedRing object, which is a single-
+ *      producer, single-consumer ring buffer in shared memory.  The shared
+ *      memory object holds a header page followed by the data region.  The
+ *      header holds the head (the position following the last committed
+ *      record, advanced by the producer) and the tail (the position
+ *      following the last released record, advanced by the consumer).
+ *      Positions increase monotonically and are reduced modulo the capacity
+ *      only when locating data, so the ring is empty when the head equals
+ *      the tail and full when they differ by the capacity.
+ *
+ *      A process that must wait sets a flag in the header and sleeps on a
+ *      futex.  The other process wakes it only if that flag is set, so no
+ *      system calls are made while the ring is neither empty nor full.
+ *
+ *  Portability Issues:
+ *      This module requires a POSIX system.  On Linux, the ring is created
+ *      using memfd_create() and waiting is performed using futexes.  On
+ *      other systems, shm_open() is used and a waiting process polls.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <span>
+#include <string>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#define VARINT_ENCODER_FUTEX 1
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "varint_encoder.h"
+#include "varint_ring.h"
+
+namespace
+{
+
+// Identifies a shared memory object holding a SharedRing ("VRNG")
+constexpr std::uint32_t Ring_Magic = 0x56524e47;
+
+// Version of the shared memory layout
+constexpr std::uint32_t Ring_Version = 1;
+
+// Maximum number of octets required to serialize a 64-bit integer
+constexpr std::size_t Max_Octets = 10;
+
+// Number of times to check for data or space before sleeping
+constexpr int Spin_Count = 256;
+
+// Largest supported ring capacity
+constexpr std::size_t Max_Capacity = std::size_t(1) << 40;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+/*
+ *  CpuRelax()
+ *
+ *  Description:
+ *      This function will hint to the processor that the caller is spinning.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/*
+ *  FutexWait()
+ *
+ *  Description:
+ *      This function will sleep until the given word is woken, provided it
+ *      still holds the expected value.
+ *
+ *  Parameters:
+ *      word [in]
+ *          The word on which to wait.
+ *
+ *      expected [in]
+ *          The value the word is expected to hold.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The caller must re-check the condition being awaited, as this
+ *      function may return spuriously.  Where futexes are not available,
+ *      this function sleeps briefly.
+ */
+void FutexWait(std::atomic<std::uint32_t> &word, std::uint32_t expected)
+{
+#if defined(VARINT_ENCODER_FUTEX)
+    syscall(SYS_futex,
+            reinterpret_cast<std::uint32_t *>(&word),
+            FUTEX_WAIT,
+            expected,
+            nullptr,
+            nullptr,
+            0);
+#else
+    struct timespec delay = {0, 50000};
+
+    if (word.load(std::memory_order_acquire) == expected)
+    {
+        nanosleep(&delay, nullptr);
+    }
+#endif
+}
+
+/*
+ *  FutexWake()
+ *
+ *  Description:
+ *      This function will advance the given word and wake all processes
+ *      waiting on it.
+ *
+ *  Parameters:
+ *      word [in]
+ *          The word on which processes are waiting.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void FutexWake(std::atomic<std::uint32_t> &word)
+{
+    word.fetch_add(1, std::memory_order_release);
+
+#if defined(VARINT_ENCODER_FUTEX)
+    syscall(SYS_futex,
+            reinterpret_cast<std::uint32_t *>(&word),
+            FUTEX_WAKE,
+            INT_MAX,
+            nullptr,
+            nullptr,
+            0);
+#endif
+}
+
+/*
+ *  RecordSize()
+ *
+ *  Description:
+ *      This function will return the number of octets a record occupies in
+ *      the ring, including its length prefix.
+ *
+ *  Parameters:
+ *      length [in]
+ *          The length of the record.
+ *
+ *  Returns:
+ *      The number of octets occupied by the record.
+ *
+ *  Comments:
+ *      None.
+ */
+std::uint64_t RecordSize(std::size_t length)
+{
+    std::uint8_t prefix[Max_Octets];
+
+    return VarIntEncoder::Serialize(prefix, std::uint64_t(length)) + length;
+}
+
+/*
+ *  CreateSharedMemory()
+ *
+ *  Description:
+ *      This function will create an anonymous shared memory object.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The file descriptor of the shared memory object, or -1 if there was
+ *      an error.
+ *
+ *  Comments:
+ *      None.
+ */
+int CreateSharedMemory()
+{
+#if defined(__linux__)
+    return memfd_create("varint_ring", MFD_CLOEXEC);
+#else
+    static std::atomic<unsigned> counter{0};
+
+    for (int attempt = 0; attempt < 16; attempt++)
+    {
+        std::string name = "/varint_ring_" + std::to_string(getpid()) + "_" +
+                           std::to_string(counter.fetch_add(1));
+
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0)
+        {
+            shm_unlink(name.c_str());
+            return fd;
+        }
+        if (errno != EEXIST) break;
+    }
+
+    return -1;
+#endif
+}
+
+} // anonymous namespace
+
+namespace VarIntEncoder
+{
+
+// The header at the start of the shared memory object
+struct SharedRing::Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t capacity;
+
+    // Written by the producer
+    alignas(64) std::atomic<std::uint64_t> head;
+    std::atomic<std::uint32_t> data_sequence;
+    std::atomic<std::uint32_t> producer_waiting;
+
+    // Written by the consumer
+    alignas(64) std::atomic<std::uint64_t> tail;
+    std::atomic<std::uint32_t> space_sequence;
+    std::atomic<std::uint32_t> consumer_waiting;
+
+    // Written by either process
+    alignas(64) std::atomic<std::uint32_t> shutdown;
+};
+
+/*
+ *  SharedRing::~SharedRing()
+ *
+ *  Description:
+ *      Destructor for the SharedRing object, which will unmap the ring.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The ring is not shut down; the other process may continue to use it.
+ */
+SharedRing::~SharedRing()
+{
+    Close();
+}
+
+/*
+ *  SharedRing::Create()
+ *
+ *  Description:
+ *      This function will create a new, empty ring.
+ *
+ *  Parameters:
+ *      capacity [in]
+ *          The number of octets in the data region, which is rounded up to
+ *          a power of two no smaller than the page size.
+ *
+ *  Returns:
+ *      True if the ring was created, false if there was an error.
+ *
+ *  Comments:
+ *      The file descriptor is created with the close-on-exec flag set.
+ */
+bool SharedRing::Create(std::size_t capacity)
+{
+    const std::size_t page_size = sysconf(_SC_PAGESIZE);
+
+    static_assert(sizeof(Header) <= 4096);
+
+    if (IsOpen() || (capacity > Max_Capacity)) return false;
+
+    this->capacity = std::bit_ceil(std::max(capacity, page_size));
+
+    fd = CreateSharedMemory();
+    if (fd < 0) return false;
+
+    if ((ftruncate(fd, page_size + this->capacity) != 0) ||
+        !Map(page_size + this->capacity))
+    {
+        Close();
+        return false;
+    }
+
+    header = new (header) Header{};
+    header->magic = Ring_Magic;
+    header->version = Ring_Version;
+    header->capacity = this->capacity;
+
+    write_position = pending_position = cached_tail = 0;
+    read_position = cached_head = 0;
+
+    return true;
+}
+
+/*
+ *  SharedRing::Attach()
+ *
+ *  Description:
+ *      This function will attach to a ring created by another SharedRing
+ *      object, usually in another process.
+ *
+ *  Parameters:
+ *      fd [in]
+ *          The file descriptor of the ring's shared memory object.  The
+ *          descriptor is duplicated, so the caller may close it.
+ *
+ *  Returns:
+ *      True if the ring was attached, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SharedRing::Attach(int fd)
+{
+    const std::size_t page_size = sysconf(_SC_PAGESIZE);
+    struct stat file_stat;
+    std::uint32_t identity[2];
+    std::uint64_t ring_capacity;
+
+    if (IsOpen()) return false;
+
+    // Verify the shared memory object holds a ring
+    if ((fstat(fd, &file_stat) != 0) ||
+        (pread(fd, identity, sizeof(identity), 0) != sizeof(identity)) ||
+        (pread(fd, &ring_capacity, sizeof(ring_capacity), sizeof(identity)) !=
+         sizeof(ring_capacity)) ||
+        (identity[0] != Ring_Magic) || (identity[1] != Ring_Version) ||
+        (ring_capacity < page_size) || (ring_capacity > Max_Capacity) ||
+        !std::has_single_bit(ring_capacity) ||
+        (static_cast<std::uint64_t>(file_stat.st_size) !=
+         page_size + ring_capacity))
+    {
+        return false;
+    }
+
+    this->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (this->fd < 0) return false;
+
+    capacity = ring_capacity;
+
+    if (!Map(page_size + capacity))
+    {
+        Close();
+        return false;
+    }
+
+    write_position = pending_position =
+        header->head.load(std::memory_order_acquire);
+    cached_tail = header->tail.load(std::memory_order_acquire);
+    read_position = cached_tail;
+    cached_head = write_position;
+
+    return true;
+}
+
+/*
+ *  SharedRing::Close()
+ *
+ *  Description:
+ *      This function will unmap the ring and close its file descriptor.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The ring is not shut down; the other process may continue to use it.
+ */
+void SharedRing::Close()
+{
+    if (mapping != nullptr) munmap(mapping, mapping_size);
+    if (fd >= 0) close(fd);
+
+    fd = -1;
+    header = nullptr;
+    data = nullptr;
+    mapping = nullptr;
+    mapping_size = 0;
+    capacity = 0;
+}
+
+/*
+ *  SharedRing::Map()
+ *
+ *  Description:
+ *      This function will map the shared memory object, mapping the data
+ *      region twice in succession.
+ *
+ *  Parameters:
+ *      size [in]
+ *          The size of the shared memory object.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SharedRing::Map(std::size_t size)
+{
+    const std::size_t page_size = size - capacity;
+
+    // Reserve address space for the header and both data mappings
+    mapping_size = page_size + 2 * capacity;
+    mapping = mmap(nullptr,
+                   mapping_size,
+                   PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS,
+                   -1,
+                   0);
+    if (mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        return false;
+    }
+
+    std::uint8_t *base = static_cast<std::uint8_t *>(mapping);
+
+    // Map the header, the data region, and the data region again
+    if ((mmap(base,
+              page_size,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED,
+              fd,
+              0) == MAP_FAILED) ||
+        (mmap(base + page_size,
+              capacity,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED,
+              fd,
+              page_size) == MAP_FAILED) ||
+        (mmap(base + page_size + capacity,
+              capacity,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED,
+              fd,
+              page_size) == MAP_FAILED))
+    {
+        return false;
+    }
+
+    header = reinterpret_cast<Header *>(base);
+    data = base + page_size;
+
+    return true;
+}
+
+/*
+ *  SharedRing::TryReserve()
+ *
+ *  Description:
+ *      This function will reserve space in the ring for a record of the
+ *      given length, if space is available.
+ *
+ *  Parameters:
+ *      length [in]
+ *          The length of the record.
+ *
+ *      record [out]
+ *          The space reserved for the record, into which the caller writes
+ *          the record.
+ *
+ *  Returns:
+ *      True if space was reserved, false if the ring does not have space
+ *      for the record, or it has been shut down.
+ *
+ *  Comments:
+ *      The record is made available to the consumer by calling Commit().
+ *      A subsequent reservation made before calling Commit() replaces this
+ *      one.  A record may be no larger than the capacity of the ring, less
+ *      the size of its length prefix.
+ */
+bool SharedRing::TryReserve(std::size_t length,
+                            std::span<std::uint8_t> &record)
+{
+    if (!IsOpen() || header->shutdown.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    const std::uint64_t required = RecordSize(length);
+
+    if (required > capacity) return false;
+
+    // Check for space, reading the tail only if the cached value is stale
+    if (write_position + required - cached_tail > capacity)
+    {
+        cached_tail = header->tail.load(std::memory_order_acquire);
+        if (write_position + required - cached_tail > capacity) return false;
+    }
+
+    std::uint8_t *octets = data + (write_position & (capacity - 1));
+    std::size_t prefix_length =
+        Serialize(std::span(octets, Max_Octets), std::uint64_t(length));
+
+    record = std::span(octets + prefix_length, length);
+    pending_position = write_position + required;
+
+    return true;
+}
+
+/*
+ *  SharedRing::Reserve()
+ *
+ *  Description:
+ *      This function will reserve space in the ring for a record of the
+ *      given length, waiting for space if necessary.
+ *
+ *  Parameters:
+ *      length [in]
+ *          The length of the record.
+ *
+ *      record [out]
+ *          The space reserved for the record, into which the caller writes
+ *          the record.
+ *
+ *  Returns:
+ *      True if space was reserved, false if the record is too large for
+ *      the ring or the ring has been shut down.
+ *
+ *  Comments:
+ *      See TryReserve().
+ */
+bool SharedRing::Reserve(std::size_t length, std::span<std::uint8_t> &record)
+{
+    while (!TryReserve(length, record))
+    {
+        if (!WaitForSpace(length)) return false;
+    }
+
+    return true;
+}
+
+/*
+ *  SharedRing::Commit()
+ *
+ *  Description:
+ *      This function will make the reserved record available to the
+ *      consumer, waking the consumer if it is waiting.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SharedRing::Commit()
+{
+    if (pending_position == write_position) return;
+
+    write_position = pending_position;
+    header->head.store(write_position, std::memory_order_release);
+
+    // Ensure the head is visible before checking whether to wake the consumer
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (header->consumer_waiting.load(std::memory_order_relaxed))
+    {
+        FutexWake(header->data_sequence);
+    }
+}
+
+/*
+ *  SharedRing::TryWrite()
+ *
+ *  Description:
+ *      This function will copy the given record into the ring, if space is
+ *      available.
+ *
+ *  Parameters:
+ *      record [in]
+ *          The record to write.
+ *
+ *  Returns:
+ *      True if the record was written, false if the ring does not have
+ *      space for the record, or it has been shut down.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SharedRing::TryWrite(std::span<const std::uint8_t> record)
+{
+    std::span<std::uint8_t> space;
+
+    if (!TryReserve(record.size(), space)) return false;
+
+    if (!record.empty())
+    {
+        std::memcpy(space.data(), record.data(), record.size());
+    }
+    Commit();
+
+    return true;
+}
+
+/*
+ *  SharedRing::Write()
+ *
+ *  Description:
+ *      This function will copy the given record into the ring, waiting for
+ *      space if necessary.
+ *
+ *  Parameters:
+ *      record [in]
+ *          The record to write.
+ *
+ *  Returns:
+ *      True if the record was written, false if the record is too large
+ *      for the ring or the ring has been shut down.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SharedRing::Write(std::span<const std::uint8_t> record)
+{
+    std::span<std::uint8_t> space;
+
+    if (!Reserve(record.size(), space)) return false;
+
+    if (!record.empty())
+    {
+        std::memcpy(space.data(), record.data(), record.size());
+    }
+    Commit();
+
+    return true;
+}
+
+/*
+ *  SharedRing::TryRead()
+ *
+ *  Description:
+ *      This function will return the next record in the ring, if one is
+ *      available.
+ *
+ *  Parameters:
+ *      record [out]
+ *          The record, which refers directly to the ring's memory.
+ *
+ *  Returns:
+ *      True if a record was read, false if the ring is empty.
+ *
+ *  Comments:
+ *      The record remains valid until Release() is called.  If the ring
+ *      holds a malformed length prefix, the ring is shut down.
+ */
+bool SharedRing::TryRead(std::span<const std::uint8_t> &record)
+{
+    if (!IsOpen()) return false;
+
+    // Check for data, reading the head only if the cached value is stale
+    if (read_position == cached_head)
+    {
+        cached_head = header->head.load(std::memory_order_acquire);
+        if (read_position == cached_head) return false;
+    }
+
+    const std::uint64_t available = cached_head - read_position;
+    const std::uint8_t *octets = data + (read_position & (capacity - 1));
+    std::uint64_t length;
+
+    std::size_t prefix_length = Deserialize(
+        std::span(octets, std::min<std::uint64_t>(available, Max_Octets)),
+        length);
+
+    if ((prefix_length == 0) || (length > available - prefix_length))
+    {
+        Shutdown();
+        return false;
+    }
+
+    record = std::span(octets + prefix_length, length);
+    read_position += prefix_length + length;
+
+    return true;
+}
+
+/*
+ *  SharedRing::Read()
+ *
+ *  Description:
+ *      This function will return the next record in the ring, waiting for
+ *      one if necessary.
+ *
+ *  Parameters:
+ *      record [out]
+ *          The record, which refers directly to the ring's memory.
+ *
+ *  Returns:
+ *      True if a record was read, false if the ring is empty and has been
+ *      shut down.
+ *
+ *  Comments:
+ *      The record remains valid until Release() is called.  If the ring is
+ *      empty, records previously read are released before waiting, since
+ *      the producer may itself be waiting for the space they occupy; those
+ *      records must not be used once Read() has been called again.
+ */
+bool SharedRing::Read(std::span<const std::uint8_t> &record)
+{
+    while (!TryRead(record))
+    {
+        // Records committed before the ring was shut down are still read
+        if (!WaitForData()) return TryRead(record);
+    }
+
+    return true;
+}
+
+/*
+ *  SharedRing::Release()
+ *
+ *  Description:
+ *      This function will release all records read, allowing the producer
+ *      to reuse the space they occupy, and wake the producer if it is
+ *      waiting for space.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Records need not be released individually; releasing records in
+ *      batches reduces the traffic between processes.
+ */
+void SharedRing::Release()
+{
+    if (!IsOpen() ||
+        (header->tail.load(std::memory_order_relaxed) == read_position))
+    {
+        return;
+    }
+
+    header->tail.store(read_position, std::memory_order_release);
+
+    // Ensure the tail is visible before checking whether to wake the producer
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (header->producer_waiting.load(std::memory_order_relaxed))
+    {
+        FutexWake(header->space_sequence);
+    }
+}
+
+/*
+ *  SharedRing::Shutdown()
+ *
+ *  Description:
+ *      This function will shut down the ring, waking both processes.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Once shut down, no further records may be written, though the
+ *      consumer may read those already committed.
+ */
+void SharedRing::Shutdown()
+{
+    if (!IsOpen()) return;
+
+    header->shutdown.store(1, std::memory_order_seq_cst);
+
+    FutexWake(header->data_sequence);
+    FutexWake(header->space_sequence);
+}
+
+/*
+ *  SharedRing::IsShutdown()
+ *
+ *  Description:
+ *      This function will report whether the ring has been shut down.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if the ring has been shut down (or is not open).
+ *
+ *  Comments:
+ *      None.
+ */
+bool SharedRing::IsShutdown() const
+{
+    return !IsOpen() || header->shutdown.load(std::memory_order_acquire);
+}
+
+/*
+ *  SharedRing::WaitForSpace()
+ *
+ *  Description:
+ *      This function will wait until the ring has space for a record of
+ *      the given length.
+ *
+ *  Parameters:
+ *      length [in]
+ *          The length of the record.
+ *
+ *  Returns:
+ *      True if there may be space for the record, false if the record is
+ *      too large for the ring or the ring has been shut down.
+ *
+ *  Comments:
+ *      The caller must re-check for space.
+ */
+bool SharedRing::WaitForSpace(std::size_t length)
+{
+    const std::uint64_t required = RecordSize(length);
+
+    if (!IsOpen() || (required > capacity)) return false;
+
+    auto has_space = [&](std::memory_order order)
+    {
+        return write_position + required -
+                   header->tail.load(order) <= capacity;
+    };
+
+    // Spin briefly, as the consumer may release space very soon
+    for (int i = 0; i < Spin_Count; i++)
+    {
+        if (header->shutdown.load(std::memory_order_acquire)) return false;
+        if (has_space(std::memory_order_acquire)) return true;
+        CpuRelax();
+    }
+
+    std::uint32_t sequence =
+        header->space_sequence.load(std::memory_order_acquire);
+
+    // Announce the wait, then check again before sleeping
+    header->producer_waiting.store(1, std::memory_order_seq_cst);
+
+    if (!has_space(std::memory_order_seq_cst) &&
+        !header->shutdown.load(std::memory_order_seq_cst))
+    {
+        FutexWait(header->space_sequence, sequence);
+    }
+
+    header->producer_waiting.store(0, std::memory_order_relaxed);
+
+    return !header->shutdown.load(std::memory_order_acquire);
+}
+
+/*
+ *  SharedRing::WaitForData()
+ *
+ *  Description:
+ *      This function will wait until the ring holds a record that has not
+ *      been read.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if there may be a record, false if the ring has been shut down.
+ *
+ *  Comments:
+ *      The caller must re-check for a record.  Records read but not yet
+ *      released are released first: if the producer is waiting for space
+ *      that only they can provide, both processes would otherwise wait
+ *      forever.
+ */
+bool SharedRing::WaitForData()
+{
+    if (!IsOpen()) return false;
+
+    Release();
+
+    auto has_data = [&](std::memory_order order)
+    {
+        return header->head.load(order) != read_position;
+    };
+
+    // Spin briefly, as the producer may commit a record very soon
+    for (int i = 0; i < Spin_Count; i++)
+    {
+        if (header->shutdown.load(std::memory_order_acquire)) return false;
+        if (has_data(std::memory_order_acquire)) return true;
+        CpuRelax();
+    }
+
+    std::uint32_t sequence =
+        header->data_sequence.load(std::memory_order_acquire);
+
+    // Announce the wait, then check again before sleeping
+    header->consumer_waiting.store(1, std::memory_order_seq_cst);
+
+    if (!has_data(std::memory_order_seq_cst) &&
+        !header->shutdown.load(std::memory_order_seq_cst))
+    {
+        FutexWait(header->data_sequence, sequence);
+    }
+
+    header->consumer_waiting.store(0, std::memory_order_relaxed);
+
+    return !header->shutdown.load(std::memory_order_acquire);
+}
+
+} // namespace VarIntEncoder
@@ -0,0 +1,493 @@
+/*
+ *  varint_segmented.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements the SegmentedReader object, which will
+ *      deserialize variable-length integers from a sequence of segments.
+ *      Within a segment, integers are located by counting the octets
+ *      having a zero MSb (each of which ends an integer), and the integers
+ *      ending in the segment are deserialized in a single call to the batch
+ *      Deserialize() function.  The octets following the last such octet
+ *      belong to an integer that continues into the next segment; those
+ *      octets and the remainder of the integer are copied into a small
+ *      buffer and deserialized from there.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <span>
+
+#include "varint_encoder.h"
+#include "varint_segmented.h"
+
+namespace
+{
+
+// Maximum number of octets required to serialize a 64-bit integer
+constexpr std::size_t Max_Octets = 10;
+
+// Number of octets examined at once when locating integers in a segment
+constexpr std::size_t Chunk_Size = 64;
+
+/*
+ *  CountTerminators()
+ *
+ *  Description:
+ *      This function will count the number of octets having a zero MSb,
+ *      which is the number of serialized integers ending in the data.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers.
+ *
+ *  Returns:
+ *      The number of octets having a zero MSb.
+ *
+ *  Comments:
+ *      The loop is written to allow the compiler to vectorize it.
+ */
+std::size_t CountTerminators(std::span<const std::uint8_t> data)
+{
+    std::size_t count = 0;
+
+    for (std::uint8_t octet : data) count += (octet >> 7) ^ 1;
+
+    return count;
+}
+
+/*
+ *  FindTerminators()
+ *
+ *  Description:
+ *      This function will locate the end of the last complete integer in
+ *      the data, considering at most the given number of integers.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers.
+ *
+ *      limit [in]
+ *          The maximum number of integers to consider.
+ *
+ *      count [out]
+ *          The number of integers ending in the returned length.
+ *
+ *  Returns:
+ *      The number of octets holding those complete integers.
+ *
+ *  Comments:
+ *      Only the octets holding the integers wanted are examined, so reading
+ *      a large segment in small batches takes time proportional to the
+ *      size of the segment.  Whole chunks are counted at once while even a
+ *      chunk of single-octet integers would not exceed the limit.
+ */
+std::size_t FindTerminators(std::span<const std::uint8_t> data,
+                            std::size_t limit,
+                            std::size_t &count)
+{
+    std::size_t position = 0;
+
+    count = 0;
+
+    // Count the terminators in whole chunks while they cannot exceed limit
+    while ((data.size() - position >= Chunk_Size) &&
+           (limit - count >= Chunk_Size))
+    {
+        count += CountTerminators(data.subspan(position, Chunk_Size));
+        position += Chunk_Size;
+    }
+
+    // Continue an octet at a time until limit is reached
+    while ((position < data.size()) && (count < limit))
+    {
+        if (!(data[position++] & 0x80)) count++;
+    }
+
+    // Exclude any octets of an integer continuing beyond the data
+    while ((position > 0) && (data[position - 1] & 0x80)) position--;
+
+    return position;
+}
+
+} // anonymous namespace
+
+namespace VarIntEncoder
+{
+
+/*
+ *  SegmentedReader::SegmentedReader()
+ *
+ *  Description:
+ *      Constructor for the SegmentedReader object.
+ *
+ *  Parameters:
+ *      segments [in]
+ *          The segments from which to deserialize integers, in order.  The
+ *          segments (and the span referring to them) must remain valid for
+ *          the lifetime of the object.  Segments may be empty.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+SegmentedReader::SegmentedReader(
+    std::span<const std::span<const std::uint8_t>> segments) :
+    segments{segments}
+{
+    SkipEmpty();
+}
+
+/*
+ *  SegmentedReader::Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize the next variable-length integer.
+ *
+ *  Parameters:
+ *      value [out]
+ *          The value read from the segments.
+ *
+ *  Returns:
+ *      The number of octets deserialized.  A zero indicates there was a
+ *      deserialization error, in which case the position is unchanged.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SegmentedReader::Deserialize(std::uint64_t &value)
+{
+    return DeserializeValue(value);
+}
+
+/*
+ *  SegmentedReader::Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize the next variable-length integer.
+ *
+ *  Parameters:
+ *      value [out]
+ *          The value read from the segments.
+ *
+ *  Returns:
+ *      The number of octets deserialized.  A zero indicates there was a
+ *      deserialization error, in which case the position is unchanged.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SegmentedReader::Deserialize(std::int64_t &value)
+{
+    return DeserializeValue(value);
+}
+
+/*
+ *  SegmentedReader::Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length
+ *      integers.
+ *
+ *  Parameters:
+ *      values [out]
+ *          The values read from the segments.  Exactly this number of values
+ *          is deserialized.
+ *
+ *  Returns:
+ *      The number of octets deserialized.  A zero indicates there was a
+ *      deserialization error, in which case the position is unchanged.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SegmentedReader::Deserialize(std::span<std::uint64_t> values)
+{
+    return DeserializeValues(values);
+}
+
+/*
+ *  SegmentedReader::Deserialize()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length
+ *      integers.
+ *
+ *  Parameters:
+ *      values [out]
+ *          The values read from the segments.  Exactly this number of values
+ *          is deserialized.
+ *
+ *  Returns:
+ *      The number of octets deserialized.  A zero indicates there was a
+ *      deserialization error, in which case the position is unchanged.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t SegmentedReader::Deserialize(std::span<std::int64_t> values)
+{
+    return DeserializeValues(values);
+}
+
+/*
+ *  SegmentedReader::AtEnd()
+ *
+ *  Description:
+ *      This function will report whether all octets have been consumed.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if there are no more octets to deserialize.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SegmentedReader::AtEnd()
+{
+    SkipEmpty();
+
+    return segment >= segments.size();
+}
+
+/*
+ *  SegmentedReader::DeserializeValue()
+ *
+ *  Description:
+ *      This function will deserialize the next variable-length integer.
+ *
+ *  Parameters:
+ *      value [out]
+ *          The value read from the segments.
+ *
+ *  Returns:
+ *      The number of octets deserialized, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+std::size_t SegmentedReader::DeserializeValue(T &value)
+{
+    std::span<const std::uint8_t> current = Current();
+
+    // Deserialize directly from the segment if the integer lies within it
+    std::size_t length = VarIntEncoder::Deserialize(current, value);
+    if (length > 0)
+    {
+        Advance(length);
+        return length;
+    }
+
+    // If the segment holds a full-length integer, the integer is invalid
+    if (current.size() >= Max_Octets) return 0;
+
+    return DeserializeStitched(value);
+}
+
+/*
+ *  SegmentedReader::DeserializeValues()
+ *
+ *  Description:
+ *      This function will deserialize a sequence of variable-length
+ *      integers.
+ *
+ *  Parameters:
+ *      values [out]
+ *          The values read from the segments.
+ *
+ *  Returns:
+ *      The number of octets deserialized, or zero if there was an error.
+ *
+ *  Comments:
+ *      On error, the position is restored to where it was on entry.
+ */
+template<typename T>
+std::size_t SegmentedReader::DeserializeValues(std::span<T> values)
+{
+    const std::size_t start_segment = segment;
+    const std::size_t start_offset = offset;
+    const std::uint64_t start_position = position;
+    std::size_t i = 0;
+
+    while (i < values.size())
+    {
+        std::span<const std::uint8_t> current = Current();
+        std::size_t count;
+        std::size_t length = FindTerminators(current,
+                                             values.size() - i,
+                                             count);
+
+        // Deserialize the integers ending within this segment
+        if (count > 0)
+        {
+            if (VarIntEncoder::Deserialize(current.first(length),
+                                           values.subspan(i, count)) !=
+                length)
+            {
+                break;
+            }
+
+            Advance(length);
+            i += count;
+            continue;
+        }
+
+        // The next integer crosses into the next segment (or is invalid)
+        if ((current.size() >= Max_Octets) ||
+            (DeserializeStitched(values[i]) == 0))
+        {
+            break;
+        }
+
+        i++;
+    }
+
+    if (i < values.size())
+    {
+        segment = start_segment;
+        offset = start_offset;
+        position = start_position;
+        return 0;
+    }
+
+    return position - start_position;
+}
+
+/*
+ *  SegmentedReader::DeserializeStitched()
+ *
+ *  Description:
+ *      This function will deserialize an integer that crosses one or more
+ *      segment boundaries by copying its octets into a temporary buffer.
+ *
+ *  Parameters:
+ *      value [out]
+ *          The value read from the segments.
+ *
+ *  Returns:
+ *      The number of octets deserialized, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+std::size_t SegmentedReader::DeserializeStitched(T &value)
+{
+    std::uint8_t octets[Max_Octets];
+    std::size_t length = 0;
+    std::size_t index = segment;
+    std::size_t index_offset = offset;
+
+    // Gather octets until one having a zero MSb is found
+    while ((length < Max_Octets) && (index < segments.size()))
+    {
+        if (index_offset >= segments[index].size())
+        {
+            index++;
+            index_offset = 0;
+            continue;
+        }
+
+        octets[length] = segments[index][index_offset++];
+        if (!(octets[length++] & 0x80)) break;
+    }
+
+    length = VarIntEncoder::Deserialize(std::span(octets, length), value);
+    if (length > 0) Advance(length);
+
+    return length;
+}
+
+/*
+ *  SegmentedReader::Current()
+ *
+ *  Description:
+ *      This function will return the unconsumed octets of the current
+ *      segment.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The unconsumed octets of the current segment, which is empty only
+ *      if all segments have been consumed.
+ *
+ *  Comments:
+ *      None.
+ */
+std::span<const std::uint8_t> SegmentedReader::Current() const
+{
+    if (segment >= segments.size()) return {};
+
+    return segments[segment].subspan(offset);
+}
+
+/*
+ *  SegmentedReader::SkipEmpty()
+ *
+ *  Description:
+ *      This function will advance past any exhausted or empty segments.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SegmentedReader::SkipEmpty()
+{
+    while ((segment < segments.size()) && (offset >= segments[segment].size()))
+    {
+        segment++;
+        offset = 0;
+    }
+}
+
+/*
+ *  SegmentedReader::Advance()
+ *
+ *  Description:
+ *      This function will advance the position by the given number of
+ *      octets, which may span segments.
+ *
+ *  Parameters:
+ *      length [in]
+ *          The number of octets to advance.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SegmentedReader::Advance(std::size_t length)
+{
+    position += length;
+
+    while (length > 0)
+    {
+        std::size_t available = segments[segment].size() - offset;
+        std::size_t step = std::min(length, available);
+
+        offset += step;
+        length -= step;
+        SkipEmpty();
+    }
+}
+
+} // namespace VarIntEncoder
@@ -0,0 +1,845 @@
+/*
+ *  varint_stream_writer.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements the StreamWriter object, which will serialize
+ *      variable-length integers into a set of large, aligned buffers and
+ *      write those buffers to a file asynchronously.  Buffers are used in
+ *      a round-robin fashion: when the current buffer is full, it is
+ *      submitted for writing and serialization continues in the next
+ *      buffer.  Only when serialization wraps around to a buffer that is
+ *      still being written does the writer wait for the disk.
+ *
+ *  Portability Issues:
+ *      This module requires a POSIX system.  The io_uring interface is
+ *      only used on Linux and requires kernel version 5.6 or later; on
+ *      other systems (or older kernels) buffers are written using pwrite().
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define VARINT_ENCODER_IO_URING 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "varint_encoder.h"
+#include "varint_stream_writer.h"
+
+namespace
+{
+
+// Alignment of buffers, file offsets, and lengths used with O_DIRECT
+constexpr std::size_t IO_Alignment = 4096;
+
+// Maximum number of octets required to serialize a 64-bit integer
+constexpr std::size_t Max_Octets = 10;
+
+/*
+ *  RoundUp()
+ *
+ *  Description:
+ *      This function will round the given value up to the next multiple
+ *      of the I/O alignment.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to round up.
+ *
+ *  Returns:
+ *      The value rounded up to a multiple of IO_Alignment.
+ *
+ *  Comments:
+ *      None.
+ */
+constexpr std::size_t RoundUp(std::size_t value)
+{
+    return (value + IO_Alignment - 1) & ~(IO_Alignment - 1);
+}
+
+} // anonymous namespace
+
+namespace VarIntEncoder
+{
+
+/*
+ *  StreamWriter::~StreamWriter()
+ *
+ *  Description:
+ *      Destructor for the StreamWriter object.  If the file is still open,
+ *      any buffered data will be written and the file closed.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Errors that occur while closing the file cannot be reported by the
+ *      destructor; call Close() explicitly to learn of such errors.
+ */
+StreamWriter::~StreamWriter()
+{
+    if (IsOpen()) Close();
+}
+
+/*
+ *  StreamWriter::Open()
+ *
+ *  Description:
+ *      This function will create (or truncate) the named file and prepare
+ *      the buffers used to write serialized integers into it.
+ *
+ *  Parameters:
+ *      filename [in]
+ *          The name of the file to write.
+ *
+ *      options [in]
+ *          Options controlling buffer sizes and the I/O method used.
+ *
+ *  Returns:
+ *      True if the file was opened successfully, false if not.
+ *
+ *  Comments:
+ *      If O_DIRECT is requested but not supported by the file system,
+ *      the file is opened without it.  Likewise, if io_uring is requested
+ *      but not available, pwrite() is used.  UsingDirectIO() and
+ *      UsingIoUring() report the methods actually in use.
+ */
+bool StreamWriter::Open(const std::string &filename,
+                        const StreamWriterOptions &options)
+{
+    // Do not open a file if one is already open
+    if (IsOpen()) return false;
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    // Attempt to open the file using O_DIRECT if requested
+#ifdef O_DIRECT
+    if (options.direct_io)
+    {
+        fd = open(filename.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) direct_io = true;
+    }
+#endif
+
+    // Open the file normally if O_DIRECT was not used
+    if (fd < 0) fd = open(filename.c_str(), flags, 0644);
+    if (fd < 0) return false;
+
+    // Allocate the aligned buffers
+    buffer_size = RoundUp(options.buffer_size ? options.buffer_size : 1);
+    buffers.resize(options.buffer_count < 2 ? 2 : options.buffer_count);
+    for (auto &buffer : buffers)
+    {
+        buffer.data = static_cast<std::uint8_t *>(
+            std::aligned_alloc(IO_Alignment, buffer_size));
+        if (buffer.data == nullptr)
+        {
+            ReleaseResources();
+            return false;
+        }
+    }
+
+    current = 0;
+    position = 0;
+    file_offset = 0;
+    in_flight = 0;
+    failed = false;
+
+    // Use io_uring if requested, falling back to pwrite() on failure
+    if (options.use_io_uring)
+    {
+        SetupIoUring(static_cast<unsigned>(buffers.size()));
+    }
+
+    return true;
+}
+
+/*
+ *  StreamWriter::Close()
+ *
+ *  Description:
+ *      This function will write any buffered data, wait for all pending
+ *      writes to complete, and close the file.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if all data was successfully written, false if any error
+ *      occurred while writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::Close()
+{
+    if (!IsOpen()) return false;
+
+    bool result = Flush();
+
+    if (close(fd) != 0) result = false;
+    fd = -1;
+
+    ReleaseResources();
+
+    return result && !failed;
+}
+
+/*
+ *  StreamWriter::Write()
+ *
+ *  Description:
+ *      This function will serialize the given unsigned integer into the
+ *      output stream.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to serialize.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::Write(std::uint64_t value)
+{
+    if (!IsOpen() || failed) return false;
+
+    // Serialize directly into the buffer when space is known to suffice
+    if ((buffer_size - position) >= Max_Octets)
+    {
+        position += Serialize(
+            std::span<std::uint8_t>(buffers[current].data + position,
+                                    Max_Octets),
+            value);
+
+        return (position < buffer_size) ? !failed : SubmitBuffer();
+    }
+
+    // Serialize the value so it may be split across buffers
+    std::uint8_t octets[Max_Octets];
+    std::size_t length = Serialize(octets, value);
+
+    return Write(std::span<const std::uint8_t>(octets, length));
+}
+
+/*
+ *  StreamWriter::Write()
+ *
+ *  Description:
+ *      This function will serialize the given signed integer into the
+ *      output stream.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to serialize.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::Write(std::int64_t value)
+{
+    if (!IsOpen() || failed) return false;
+
+    // Serialize directly into the buffer when space is known to suffice
+    if ((buffer_size - position) >= Max_Octets)
+    {
+        position += Serialize(
+            std::span<std::uint8_t>(buffers[current].data + position,
+                                    Max_Octets),
+            value);
+
+        return (position < buffer_size) ? !failed : SubmitBuffer();
+    }
+
+    // Serialize the value so it may be split across buffers
+    std::uint8_t octets[Max_Octets];
+    std::size_t length = Serialize(octets, value);
+
+    return Write(std::span<const std::uint8_t>(octets, length));
+}
+
+/*
+ *  StreamWriter::Write()
+ *
+ *  Description:
+ *      This function will append the given octets to the output stream.
+ *      This may be used to insert previously serialized data or other
+ *      content between serialized integers.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The octets to write.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::Write(std::span<const std::uint8_t> data)
+{
+    if (!IsOpen() || failed) return false;
+
+    while (!data.empty())
+    {
+        std::size_t length = std::min(data.size(), buffer_size - position);
+
+        std::memcpy(buffers[current].data + position, data.data(), length);
+        position += length;
+        data = data.subspan(length);
+
+        if ((position == buffer_size) && !SubmitBuffer()) return false;
+    }
+
+    return true;
+}
+
+/*
+ *  StreamWriter::Flush()
+ *
+ *  Description:
+ *      This function will write any partially filled buffer to the file
+ *      and wait for all pending writes to complete.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      The partially filled buffer remains the current buffer so that
+ *      subsequent writes continue to fill it.  When the buffer is later
+ *      submitted in full, the flushed region is simply written again.
+ *      This keeps all file offsets aligned, as is required for O_DIRECT.
+ */
+bool StreamWriter::Flush()
+{
+    if (!IsOpen()) return false;
+
+    if (!WaitForAll()) return false;
+
+    if (position == 0) return !failed;
+
+    // When using O_DIRECT, pad the final block with zeros
+    std::size_t length = position;
+    if (direct_io)
+    {
+        length = RoundUp(position);
+        std::memset(buffers[current].data + position, 0, length - position);
+    }
+
+    if (!WriteBuffer(current, length, file_offset) || !WaitForAll())
+    {
+        return false;
+    }
+
+    // Remove any padding written to the end of the file
+    if (direct_io && (ftruncate(fd, file_offset + position) != 0))
+    {
+        failed = true;
+    }
+
+    return !failed;
+}
+
+/*
+ *  StreamWriter::SubmitBuffer()
+ *
+ *  Description:
+ *      This function will submit the current (full) buffer for writing
+ *      and advance to the next buffer, waiting for that buffer to be
+ *      available if it is still being written.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::SubmitBuffer()
+{
+    if (!WriteBuffer(current, position, file_offset)) return false;
+
+    file_offset += position;
+    position = 0;
+    current = (current + 1) % buffers.size();
+
+    return WaitForBuffer(current);
+}
+
+/*
+ *  StreamWriter::WriteBuffer()
+ *
+ *  Description:
+ *      This function will initiate the writing of the given buffer to the
+ *      file.  When using io_uring, the write is submitted and this function
+ *      returns immediately.  Otherwise, the write is performed using
+ *      pwrite() and completes before this function returns.
+ *
+ *  Parameters:
+ *      index [in]
+ *          The index of the buffer to write.
+ *
+ *      length [in]
+ *          The number of octets in the buffer to write.
+ *
+ *      offset [in]
+ *          The file offset at which to write the buffer.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::WriteBuffer(std::size_t index,
+                               std::size_t length,
+                               std::uint64_t offset)
+{
+    Buffer &buffer = buffers[index];
+
+    buffer.length = length;
+    buffer.offset = offset;
+
+#ifdef VARINT_ENCODER_IO_URING
+    if (ring_fd >= 0)
+    {
+        std::atomic_ref<unsigned> tail_ref(*sq_tail);
+        unsigned tail = tail_ref.load(std::memory_order_relaxed);
+        unsigned slot = tail & *sq_mask;
+        io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes) + slot;
+
+        // Prepare the submission queue entry
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<std::uint64_t>(buffer.data);
+        sqe->len = static_cast<std::uint32_t>(length);
+        sqe->user_data = index;
+
+        // Publish the entry to the kernel
+        sq_array[slot] = slot;
+        tail_ref.store(tail + 1, std::memory_order_release);
+
+        int result;
+        do
+        {
+            result = static_cast<int>(
+                syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0));
+        } while ((result < 0) && (errno == EINTR));
+
+        if (result != 1)
+        {
+            failed = true;
+            return false;
+        }
+
+        buffer.in_flight = true;
+        in_flight++;
+
+        return true;
+    }
+#endif
+
+    return CompleteWrite(index, 0);
+}
+
+/*
+ *  StreamWriter::CompleteWrite()
+ *
+ *  Description:
+ *      This function will write any portion of the given buffer that
+ *      has not yet been written to the file using pwrite().  This is
+ *      used both when io_uring is not in use and to complete short
+ *      writes reported by io_uring.
+ *
+ *  Parameters:
+ *      index [in]
+ *          The index of the buffer to write.
+ *
+ *      written [in]
+ *          The number of octets of the buffer already written.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::CompleteWrite(std::size_t index, std::size_t written)
+{
+    Buffer &buffer = buffers[index];
+
+    while (written < buffer.length)
+    {
+        ssize_t result = pwrite(fd,
+                                buffer.data + written,
+                                buffer.length - written,
+                                static_cast<off_t>(buffer.offset + written));
+
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            failed = true;
+            return false;
+        }
+
+        // A zero-length write indicates no further progress can be made
+        if (result == 0)
+        {
+            failed = true;
+            return false;
+        }
+
+        written += static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+/*
+ *  StreamWriter::ReapCompletions()
+ *
+ *  Description:
+ *      This function will wait for at least one write submitted via
+ *      io_uring to complete and will process all available completions.
+ *      Any write that failed will cause the writer to enter a failed
+ *      state, though remaining completions continue to be processed.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if completions were processed, false if it was not possible
+ *      to wait for completions.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::ReapCompletions()
+{
+#ifdef VARINT_ENCODER_IO_URING
+    std::atomic_ref<unsigned> head_ref(*cq_head);
+    std::atomic_ref<unsigned> tail_ref(*cq_tail);
+    unsigned head = head_ref.load(std::memory_order_relaxed);
+
+    // Wait for a completion if none are presently available
+    if (head == tail_ref.load(std::memory_order_acquire))
+    {
+        int result;
+        do
+        {
+            result = static_cast<int>(syscall(__NR_io_uring_enter,
+                                              ring_fd,
+                                              0,
+                                              1,
+                                              IORING_ENTER_GETEVENTS,
+                                              nullptr,
+                                              0));
+        } while ((result < 0) && (errno == EINTR));
+
+        if (result < 0)
+        {
+            failed = true;
+            return false;
+        }
+    }
+
+    // Process all available completion queue entries
+    unsigned tail = tail_ref.load(std::memory_order_acquire);
+    while (head != tail)
+    {
+        const io_uring_cqe *cqe =
+            static_cast<const io_uring_cqe *>(cqes) + (head & *cq_mask);
+        std::size_t index = static_cast<std::size_t>(cqe->user_data);
+        int result = cqe->res;
+
+        head++;
+        head_ref.store(head, std::memory_order_release);
+
+        buffers[index].in_flight = false;
+        in_flight--;
+
+        if (result < 0)
+        {
+            failed = true;
+        }
+        else
+        {
+            CompleteWrite(index, static_cast<std::size_t>(result));
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ *  StreamWriter::WaitForBuffer()
+ *
+ *  Description:
+ *      This function will wait until the given buffer is no longer being
+ *      written to the file.
+ *
+ *  Parameters:
+ *      index [in]
+ *          The index of the buffer to wait on.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::WaitForBuffer(std::size_t index)
+{
+    while (buffers[index].in_flight)
+    {
+        if (!ReapCompletions()) break;
+    }
+
+    return !failed;
+}
+
+/*
+ *  StreamWriter::WaitForAll()
+ *
+ *  Description:
+ *      This function will wait until all submitted writes complete.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error writing the file.
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::WaitForAll()
+{
+    while (in_flight > 0)
+    {
+        if (!ReapCompletions()) break;
+    }
+
+    return !failed;
+}
+
+/*
+ *  StreamWriter::SetupIoUring()
+ *
+ *  Description:
+ *      This function will create an io_uring instance and map its
+ *      submission and completion queues into memory.
+ *
+ *  Parameters:
+ *      entries [in]
+ *          The minimum number of submission queue entries required.
+ *
+ *  Returns:
+ *      True if io_uring is available and ready for use, false if not.
+ *      If false, writes will be performed using pwrite().
+ *
+ *  Comments:
+ *      None.
+ */
+bool StreamWriter::SetupIoUring([[maybe_unused]] unsigned entries)
+{
+#ifdef VARINT_ENCODER_IO_URING
+    io_uring_params params{};
+
+    ring_fd = static_cast<int>(
+        syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd < 0) return false;
+
+    // IORING_OP_WRITE requires the features introduced in Linux 5.6
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+        TeardownIoUring();
+        return false;
+    }
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes +
+                   params.cq_entries * sizeof(io_uring_cqe);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+    // Newer kernels map both rings with a single mapping
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+
+    sq_ring = mmap(nullptr,
+                   sq_ring_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE,
+                   ring_fd,
+                   IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED)
+    {
+        sq_ring = nullptr;
+        TeardownIoUring();
+        return false;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        cq_ring = sq_ring;
+    }
+    else
+    {
+        cq_ring = mmap(nullptr,
+                       cq_ring_size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE,
+                       ring_fd,
+                       IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED)
+        {
+            cq_ring = nullptr;
+            TeardownIoUring();
+            return false;
+        }
+    }
+
+    sqes = mmap(nullptr,
+                sqes_size,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE,
+                ring_fd,
+                IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        sqes = nullptr;
+        TeardownIoUring();
+        return false;
+    }
+
+    // Locate the fields within the mapped rings
+    auto sq_base = static_cast<std::uint8_t *>(sq_ring);
+    auto cq_base = static_cast<std::uint8_t *>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned *>(sq_base + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned *>(sq_base + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq_base + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned *>(cq_base + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq_base + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq_base + params.cq_off.ring_mask);
+    cqes = cq_base + params.cq_off.cqes;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ *  StreamWriter::TeardownIoUring()
+ *
+ *  Description:
+ *      This function will unmap the io_uring queues and close the
+ *      io_uring file descriptor.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void StreamWriter::TeardownIoUring()
+{
+#ifdef VARINT_ENCODER_IO_URING
+    if (sqes != nullptr) munmap(sqes, sqes_size);
+    if ((cq_ring != nullptr) && (cq_ring != sq_ring))
+    {
+        munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != nullptr) munmap(sq_ring, sq_ring_size);
+    if (ring_fd >= 0) close(ring_fd);
+#endif
+
+    ring_fd = -1;
+    sq_ring = nullptr;
+    cq_ring = nullptr;
+    sqes = nullptr;
+    sq_tail = sq_mask = sq_array = nullptr;
+    cq_head = cq_tail = cq_mask = nullptr;
+    cqes = nullptr;
+}
+
+/*
+ *  StreamWriter::ReleaseResources()
+ *
+ *  Description:
+ *      This function will release the buffers and io_uring resources.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Normally, all writes have completed before this is called.  If it
+ *      was not possible to wait for a write to complete, the kernel may
+ *      still be reading from its buffer, so that buffer is deliberately
+ *      not freed.  Any unwritten octets are counted by BytesWritten() so
+ *      that it reports the same value as before the file was closed.
+ */
+void StreamWriter::ReleaseResources()
+{
+    TeardownIoUring();
+
+    for (auto &buffer : buffers)
+    {
+        if (!buffer.in_flight) std::free(buffer.data);
+    }
+    buffers.clear();
+
+    if (fd >= 0) close(fd);
+    fd = -1;
+    direct_io = false;
+    in_flight = 0;
+    file_offset += position;
+    position = 0;
+    buffer_size = 0;
+    current = 0;
+}
+
+} // namespace VarIntEncoder
@@ -0,0 +1,1178 @@
+/*
+ *  varint_transcoder.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This module implements functions that will convert entire buffers of
+ *      serialized integers between the variable-length integer encoding
+ *      produced by this library and other integer encodings.
+ *
+ *      Conversion to and from LEB128 is particularly simple, since both
+ *      encodings use the same number of octets and place the continuation
+ *      bit in the same octets.  Only the order of the groups of 7 bits
+ *      differs, so converting in either direction reverses the groups
+ *      within each integer while leaving the continuation bits in place.
+ *      This holds for signed integers too, as both encodings sign-extend
+ *      the most significant group.
+ *
+ *      Conversion to and from QUIC (RFC 9000) and CBOR (RFC 8949) integers
+ *      is performed one integer at a time: each integer is read into a
+ *      register, checked against the range of the target encoding, and
+ *      written directly to the output buffer.
+ *
+ *  Portability Issues:
+ *      The vectorized paths are used only on little-endian systems.  SSE2
+ *      is used when available and portable 64-bit operations otherwise.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <bit>
+#include <limits>
+#include <span>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define VARINT_ENCODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "varint_transcoder.h"
+
+namespace
+{
+
+// Mask selecting the continuation bit of each octet in a 64-bit word
+constexpr std::uint64_t Continuation_Bits = 0x8080808080808080;
+
+/*
+ *  ByteSwap()
+ *
+ *  Description:
+ *      This function will reverse the order of the octets in the given
+ *      64-bit integer.
+ *
+ *  Parameters:
+ *      v [in]
+ *          The value whose octets are to be reversed.
+ *
+ *  Returns:
+ *      The value with its octets reversed.
+ *
+ *  Comments:
+ *      None.
+ */
+inline std::uint64_t ByteSwap(std::uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(v);
+#else
+    v = ((v & 0x00ff00ff00ff00ff) << 8) | ((v >> 8) & 0x00ff00ff00ff00ff);
+    v = ((v & 0x0000ffff0000ffff) << 16) | ((v >> 16) & 0x0000ffff0000ffff);
+    return (v << 32) | (v >> 32);
+#endif
+}
+
+/*
+ *  ReverseGroupsScalar()
+ *
+ *  Description:
+ *      This function will reverse the order of the groups of 7 bits of the
+ *      single integer at the start of the input buffer, writing the result
+ *      to the output buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integer to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integer.
+ *
+ *      available [in]
+ *          The number of octets available in the input buffer.
+ *
+ *      leb128_input [in]
+ *          True if the input is LEB128, which places the most significant
+ *          group in the final octet rather than the first.
+ *
+ *  Returns:
+ *      The number of octets transcoded, or zero if the integer is
+ *      incomplete, longer than 10 octets, or a 10-octet integer whose most
+ *      significant group is invalid.
+ *
+ *  Comments:
+ *      Since the transcoder does not know whether integers are signed, the
+ *      most significant group of a 10-octet integer may hold any value
+ *      valid for either: 0x00 or 0x01 (unsigned) or 0x00 or 0x7f (signed).
+ */
+std::size_t ReverseGroupsScalar(const std::uint8_t *input,
+                                std::uint8_t *output,
+                                std::size_t available,
+                                bool leb128_input)
+{
+    std::uint8_t groups[10];
+    std::size_t length{0};
+
+    // Locate the final octet of the integer
+    do
+    {
+        // A 64-bits value should never require more than 10 octets
+        if ((length == 10) || (length == available)) return 0;
+
+        groups[length] = input[length] & 0x7f;
+    } while (input[length++] & 0x80);
+
+    // Only bit 63 (or the sign) may be carried by a 10th group
+    if (length == 10)
+    {
+        std::uint8_t group = groups[leb128_input ? 9 : 0];
+        if ((group != 0x00) && (group != 0x01) && (group != 0x7f)) return 0;
+    }
+
+    // Write the groups in reverse order, keeping the continuation bits
+    for (std::size_t i = 0; i < length; i++)
+    {
+        output[i] = groups[length - 1 - i] | (input[i] & 0x80);
+    }
+
+    return length;
+}
+
+/*
+ *  ReverseGroups()
+ *
+ *  Description:
+ *      This function will reverse the order of the groups of 7 bits of
+ *      every integer in the input buffer, writing the result to the output
+ *      buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      leb128_input [in]
+ *          True if the input is LEB128, false if it was produced by
+ *          Serialize().
+ *
+ *  Returns:
+ *      The number of octets transcoded, or zero if there was an error.
+ *
+ *  Comments:
+ *      Single-octet integers are unchanged by transcoding, so runs of
+ *      them are copied 16 (or 8) octets at a time.  Integers of up to 8
+ *      octets are reversed within a 64-bit register.  Only longer integers
+ *      and those near the end of the buffer are processed an octet at a
+ *      time.  When writing a 64-bit word, octets beyond the integer are
+ *      rewritten with their input values, so transcoding in place is safe.
+ */
+std::size_t ReverseGroups(std::span<const std::uint8_t> input,
+                          std::span<std::uint8_t> output,
+                          bool leb128_input)
+{
+    const std::uint8_t *in = input.data();
+    std::uint8_t *out = output.data();
+    const std::size_t size = input.size();
+    std::size_t position{0};
+
+    if (input.empty() || (output.size() < size)) return 0;
+
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        while (position + 16 <= size)
+        {
+#ifdef VARINT_ENCODER_SSE2
+            // Copy 16 single-octet integers at once
+            __m128i chunk = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(in + position));
+            if (_mm_movemask_epi8(chunk) == 0)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + position),
+                                 chunk);
+                position += 16;
+                continue;
+            }
+#endif
+
+            std::uint64_t word;
+            std::memcpy(&word, in + position, sizeof(word));
+
+            // Copy 8 single-octet integers at once
+            std::uint64_t terminators = ~word & Continuation_Bits;
+            if (terminators == Continuation_Bits)
+            {
+                std::memcpy(out + position, &word, sizeof(word));
+                position += 8;
+                continue;
+            }
+
+            // Integers longer than 8 octets are handled separately
+            if (terminators == 0)
+            {
+                std::size_t length =
+                    ReverseGroupsScalar(in + position,
+                                        out + position,
+                                        size - position,
+                                        leb128_input);
+                if (length == 0) return 0;
+                position += length;
+                continue;
+            }
+
+            // Reverse the octets of the integer within the word
+            std::size_t length = std::countr_zero(terminators) / 8 + 1;
+            std::size_t shift = 64 - 8 * length;
+            std::uint64_t mask = ~std::uint64_t(0) >> shift;
+            std::uint64_t reversed = ByteSwap(word) >> shift;
+
+            // Restore the continuation bits and any following octets
+            word = (reversed & mask & ~Continuation_Bits) |
+                   (word & Continuation_Bits & mask) |
+                   (word & ~mask);
+
+            std::memcpy(out + position, &word, sizeof(word));
+            position += length;
+        }
+    }
+
+    // Transcode any remaining integers an octet at a time
+    while (position < size)
+    {
+        std::size_t length = ReverseGroupsScalar(in + position,
+                                                 out + position,
+                                                 size - position,
+                                                 leb128_input);
+        if (length == 0) return 0;
+        position += length;
+    }
+
+    return size;
+}
+
+/*
+ *  VarUintFormat
+ *
+ *  Description:
+ *      This structure provides functions to read, size, and write unsigned
+ *      integers using the encoding produced by Serialize().
+ *
+ *      Read() returns the number of octets read (zero on error), Size()
+ *      returns the number of octets required to write the value (zero if
+ *      the value cannot be represented), and Write() writes the value
+ *      using the given number of octets.
+ *
+ *  Comments:
+ *      The same functions are provided by each of the following structures
+ *      so that they may be combined by Transcode() and TranscodedSize().
+ */
+struct VarUintFormat
+{
+    using Value = std::uint64_t;
+
+    static std::size_t Read(const std::uint8_t *input,
+                            std::size_t available,
+                            Value &value)
+    {
+        const std::size_t limit = (available < 10) ? available : 10;
+
+        value = 0;
+
+        for (std::size_t i = 0; i < limit; i++)
+        {
+            value = (value << 7) | (input[i] & 0x7f);
+
+            if (!(input[i] & 0x80))
+            {
+                // If the total length is 10 octets, initial octet must be
+                // 0x80 or 0x81
+                if ((i == 9) && (input[0] != 0x80) && (input[0] != 0x81))
+                {
+                    return 0;
+                }
+
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    static std::size_t Size(Value value)
+    {
+        const std::size_t bits = std::bit_width(value);
+
+        return (bits ? bits + 6 : 7) / 7;
+    }
+
+    static void Write(std::uint8_t *output, Value value, std::size_t length)
+    {
+        output[length - 1] = value & 0x7f;
+
+        for (std::size_t i = length - 1; i > 0; i--)
+        {
+            value >>= 7;
+            output[i - 1] = (value & 0x7f) | 0x80;
+        }
+    }
+};
+
+/*
+ *  VarIntFormat
+ *
+ *  Description:
+ *      This structure provides functions to read, size, and write signed
+ *      integers using the encoding produced by Serialize().
+ *
+ *  Comments:
+ *      See VarUintFormat.
+ */
+struct VarIntFormat
+{
+    using Value = std::int64_t;
+
+    static std::size_t Read(const std::uint8_t *input,
+                            std::size_t available,
+                            Value &value)
+    {
+        const std::size_t limit = (available < 10) ? available : 10;
+
+        if (available == 0) return 0;
+
+        // Determine the sign of the number by inspecting the leading sign bit
+        std::uint64_t bits = (input[0] & 0x40) ? ~std::uint64_t(0) : 0;
+
+        for (std::size_t i = 0; i < limit; i++)
+        {
+            bits = (bits << 7) | (input[i] & 0x7f);
+
+            if (!(input[i] & 0x80))
+            {
+                // If the total length is 10 octets, ensure the initial octet
+                // is one of the only two valid values
+                if ((i == 9) && (input[0] != 0x80) && (input[0] != 0xff))
+                {
+                    return 0;
+                }
+
+                value = static_cast<Value>(bits);
+
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    static std::size_t Size(Value value)
+    {
+        const std::uint64_t magnitude =
+            static_cast<std::uint64_t>(value ^ (value >> 63));
+
+        return (std::bit_width(magnitude) + 7) / 7;
+    }
+
+    static void Write(std::uint8_t *output, Value value, std::size_t length)
+    {
+        output[length - 1] = value & 0x7f;
+
+        // Shifting the signed value extends the sign into the leading octet
+        for (std::size_t i = length - 1; i > 0; i--)
+        {
+            value >>= 7;
+            output[i - 1] = (value & 0x7f) | 0x80;
+        }
+    }
+};
+
+/*
+ *  QUICFormat
+ *
+ *  Description:
+ *      This structure provides functions to read, size, and write unsigned
+ *      integers using the variable-length integer encoding defined in
+ *      section 16 of RFC 9000 (QUIC).  The two most significant bits of the
+ *      first octet indicate a length of 1, 2, 4, or 8 octets, leaving 62
+ *      bits for the value.
+ *
+ *  Comments:
+ *      Values are written using the shortest possible encoding, though any
+ *      valid encoding is accepted when reading.
+ */
+struct QUICFormat
+{
+    using Value = std::uint64_t;
+
+    static std::size_t Read(const std::uint8_t *input,
+                            std::size_t available,
+                            Value &value)
+    {
+        if (available == 0) return 0;
+
+        const std::size_t length = std::size_t(1) << (input[0] >> 6);
+
+        if (length > available) return 0;
+
+        value = input[0] & 0x3f;
+        for (std::size_t i = 1; i < length; i++)
+        {
+            value = (value << 8) | input[i];
+        }
+
+        return length;
+    }
+
+    static std::size_t Size(Value value)
+    {
+        if (value <= 0x3f) return 1;
+        if (value <= 0x3fff) return 2;
+        if (value <= 0x3fff'ffff) return 4;
+        if (value <= 0x3fff'ffff'ffff'ffff) return 8;
+
+        return 0;
+    }
+
+    static void Write(std::uint8_t *output, Value value, std::size_t length)
+    {
+        for (std::size_t i = length; i > 0; i--)
+        {
+            output[i - 1] = value & 0xff;
+            value >>= 8;
+        }
+
+        // Insert the length into the two most significant bits
+        output[0] |= static_cast<std::uint8_t>(std::countr_zero(length) << 6);
+    }
+};
+
+/*
+ *  CBORHead
+ *
+ *  Description:
+ *      This structure provides functions to read, size, and write the
+ *      initial octet and argument of a CBOR data item (RFC 8949, section 3),
+ *      as used to represent integers of major types 0 and 1.
+ *
+ *  Comments:
+ *      The argument is written using the preferred (shortest) encoding,
+ *      though any encoding is accepted when reading.
+ */
+struct CBORHead
+{
+    static std::size_t Read(const std::uint8_t *input,
+                            std::size_t available,
+                            std::uint8_t &major_type,
+                            std::uint64_t &argument)
+    {
+        if (available == 0) return 0;
+
+        const std::uint8_t additional_info = input[0] & 0x1f;
+        std::size_t length;
+
+        major_type = input[0] >> 5;
+
+        if (additional_info < 24)
+        {
+            argument = additional_info;
+            return 1;
+        }
+
+        // Only additional information values 24 through 27 are valid
+        if (additional_info > 27) return 0;
+
+        length = std::size_t(1) << (additional_info - 24);
+        if (length >= available) return 0;
+
+        argument = 0;
+        for (std::size_t i = 1; i <= length; i++)
+        {
+            argument = (argument << 8) | input[i];
+        }
+
+        return length + 1;
+    }
+
+    static std::size_t Size(std::uint64_t argument)
+    {
+        if (argument < 24) return 1;
+        if (argument <= 0xff) return 2;
+        if (argument <= 0xffff) return 3;
+        if (argument <= 0xffff'ffff) return 5;
+
+        return 9;
+    }
+
+    static void Write(std::uint8_t *output,
+                      std::uint8_t major_type,
+                      std::uint64_t argument,
+                      std::size_t length)
+    {
+        if (length == 1)
+        {
+            output[0] =
+                static_cast<std::uint8_t>((major_type << 5) | argument);
+            return;
+        }
+
+        output[0] = static_cast<std::uint8_t>(
+            (major_type << 5) | (24 + std::countr_zero(length - 1)));
+
+        for (std::size_t i = length - 1; i > 0; i--)
+        {
+            output[i] = argument & 0xff;
+            argument >>= 8;
+        }
+    }
+};
+
+/*
+ *  CBORUintFormat
+ *
+ *  Description:
+ *      This structure provides functions to read, size, and write unsigned
+ *      integers as CBOR major type 0 data items.
+ *
+ *  Comments:
+ *      Negative integers (major type 1) cannot be represented as unsigned
+ *      integers and result in an error when read.
+ */
+struct CBORUintFormat
+{
+    using Value = std::uint64_t;
+
+    static std::size_t Read(const std::uint8_t *input,
+                            std::size_t available,
+                            Value &value)
+    {
+        std::uint8_t major_type{};
+        std::size_t length =
+            CBORHead::Read(input, available, major_type, value);
+
+        return (major_type == 0) ? length : 0;
+    }
+
+    static std::size_t Size(Value value)
+    {
+        return CBORHead::Size(value);
+    }
+
+    static void Write(std::uint8_t *output, Value value, std::size_t length)
+    {
+        CBORHead::Write(output, 0, value, length);
+    }
+};
+
+/*
+ *  CBORIntFormat
+ *
+ *  Description:
+ *      This structure provides functions to read, size, and write signed
+ *      integers as CBOR major type 0 (non-negative) or major type 1
+ *      (negative) data items.  A negative integer n is represented by
+ *      the argument -1 - n.
+ *
+ *  Comments:
+ *      CBOR integers whose values fall outside the range of a 64-bit
+ *      signed integer result in an error when read.
+ */
+struct CBORIntFormat
+{
+    using Value = std::int64_t;
+
+    static std::size_t Read(const std::uint8_t *input,
+                            std::size_t available,
+                            Value &value)
+    {
+        std::uint8_t major_type{};
+        std::uint64_t argument{};
+        std::size_t length =
+            CBORHead::Read(input, available, major_type, argument);
+
+        if ((major_type > 1) ||
+            (argument > std::numeric_limits<std::int64_t>::max()))
+        {
+            return 0;
+        }
+
+        value = static_cast<Value>(major_type ? ~argument : argument);
+
+        return length;
+    }
+
+    static std::size_t Size(Value value)
+    {
+        return CBORHead::Size(static_cast<std::uint64_t>(
+            (value < 0) ? ~value : value));
+    }
+
+    static void Write(std::uint8_t *output, Value value, std::size_t length)
+    {
+        if (value < 0)
+        {
+            CBORHead::Write(output,
+                            1,
+                            static_cast<std::uint64_t>(~value),
+                            length);
+        }
+        else
+        {
+            CBORHead::Write(output,
+                            0,
+                            static_cast<std::uint64_t>(value),
+                            length);
+        }
+    }
+};
+
+/*
+ *  Transcode()
+ *
+ *  Description:
+ *      This function will convert a buffer of integers serialized using
+ *      one encoding into a buffer of integers serialized using another.
+ *      Each integer is read, checked, and written in turn, with no
+ *      intermediate array of integers.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename From, typename To>
+std::size_t Transcode(std::span<const std::uint8_t> input,
+                      std::span<std::uint8_t> output,
+                      std::size_t &consumed)
+{
+    const std::uint8_t *in = input.data();
+    std::uint8_t *out = output.data();
+    std::size_t position{0};
+    std::size_t produced{0};
+
+    while (position < input.size())
+    {
+        typename From::Value value;
+
+        // Read the next integer
+        std::size_t read_length =
+            From::Read(in + position, input.size() - position, value);
+        if (read_length == 0) break;
+
+        // Ensure the integer may be represented and fits in the output
+        std::size_t write_length = To::Size(value);
+        if ((write_length == 0) || (write_length > output.size() - produced))
+        {
+            break;
+        }
+
+        To::Write(out + produced, value, write_length);
+
+        position += read_length;
+        produced += write_length;
+    }
+
+    consumed = position;
+
+    return (position == input.size()) ? produced : 0;
+}
+
+/*
+ *  TranscodedSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets required to
+ *      convert a buffer of integers serialized using one encoding into
+ *      integers serialized using another.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename From, typename To>
+std::size_t TranscodedSize(std::span<const std::uint8_t> input,
+                           std::size_t &consumed)
+{
+    const std::uint8_t *in = input.data();
+    std::size_t position{0};
+    std::size_t required{0};
+
+    while (position < input.size())
+    {
+        typename From::Value value;
+
+        // Read the next integer
+        std::size_t read_length =
+            From::Read(in + position, input.size() - position, value);
+        if (read_length == 0) break;
+
+        // Ensure the integer may be represented
+        std::size_t write_length = To::Size(value);
+        if (write_length == 0) break;
+
+        position += read_length;
+        required += write_length;
+    }
+
+    consumed = position;
+
+    return (position == input.size()) ? required : 0;
+}
+
+} // anonymous namespace
+
+namespace VarIntEncoder
+{
+
+/*
+ *  TranscodeToLEB128()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      variable-length integers serialized by Serialize() into the same
+ *      sequence of integers serialized using LEB128.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the serialized integers.
+ *
+ *      output [out]
+ *          The buffer into which to write the LEB128 integers.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, which is always
+ *      equal to the size of the input buffer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToLEB128(std::span<const std::uint8_t> input,
+                              std::span<std::uint8_t> output)
+{
+    return ReverseGroups(input, output, false);
+}
+
+/*
+ *  TranscodeFromLEB128()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      LEB128 integers into the same sequence of integers serialized
+ *      as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the LEB128 integers.
+ *
+ *      output [out]
+ *          The buffer into which to write the serialized integers.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, which is always
+ *      equal to the size of the input buffer, or zero if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromLEB128(std::span<const std::uint8_t> input,
+                                std::span<std::uint8_t> output)
+{
+    return ReverseGroups(input, output, true);
+}
+
+/*
+ *  TranscodeToQUIC()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      unsigned integers serialized by Serialize() into the same sequence of
+ *      integers serialized using QUIC variable-length encoding.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Values greater than 2^62 - 1 cannot be represented and result in an
+ *      error.
+ */
+std::size_t TranscodeToQUIC(std::span<const std::uint8_t> input,
+                            std::span<std::uint8_t> output,
+                            std::size_t &consumed)
+{
+    return Transcode<VarUintFormat, QUICFormat>(input, output, consumed);
+}
+
+/*
+ *  TranscodeToQUICSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeToQUIC() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToQUICSize(std::span<const std::uint8_t> input,
+                                std::size_t &consumed)
+{
+    return TranscodedSize<VarUintFormat, QUICFormat>(input, consumed);
+}
+
+/*
+ *  TranscodeFromQUIC()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      QUIC variable-length integers into the same sequence of
+ *      unsigned integers serialized as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromQUIC(std::span<const std::uint8_t> input,
+                              std::span<std::uint8_t> output,
+                              std::size_t &consumed)
+{
+    return Transcode<QUICFormat, VarUintFormat>(input, output, consumed);
+}
+
+/*
+ *  TranscodeFromQUICSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeFromQUIC() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromQUICSize(std::span<const std::uint8_t> input,
+                                  std::size_t &consumed)
+{
+    return TranscodedSize<QUICFormat, VarUintFormat>(input, consumed);
+}
+
+/*
+ *  TranscodeToCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      unsigned integers serialized by Serialize() into the same sequence of
+ *      integers serialized as CBOR major type 0 data items.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToCBOR(std::span<const std::uint8_t> input,
+                            std::span<std::uint8_t> output,
+                            std::size_t &consumed)
+{
+    return Transcode<VarUintFormat, CBORUintFormat>(input, output, consumed);
+}
+
+/*
+ *  TranscodeToCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeToCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeToCBORSize(std::span<const std::uint8_t> input,
+                                std::size_t &consumed)
+{
+    return TranscodedSize<VarUintFormat, CBORUintFormat>(input, consumed);
+}
+
+/*
+ *  TranscodeFromCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      CBOR major type 0 data items into the same sequence of
+ *      unsigned integers serialized as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Negative integers (major type 1) and other data items cannot be
+ *      represented and result in an error.
+ */
+std::size_t TranscodeFromCBOR(std::span<const std::uint8_t> input,
+                              std::span<std::uint8_t> output,
+                              std::size_t &consumed)
+{
+    return Transcode<CBORUintFormat, VarUintFormat>(input, output, consumed);
+}
+
+/*
+ *  TranscodeFromCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeFromCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeFromCBORSize(std::span<const std::uint8_t> input,
+                                  std::size_t &consumed)
+{
+    return TranscodedSize<CBORUintFormat, VarUintFormat>(input, consumed);
+}
+
+/*
+ *  TranscodeSignedToCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      signed integers serialized by Serialize() into the same sequence of
+ *      integers serialized as CBOR major type 0 or 1 data items.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeSignedToCBOR(std::span<const std::uint8_t> input,
+                                  std::span<std::uint8_t> output,
+                                  std::size_t &consumed)
+{
+    return Transcode<VarIntFormat, CBORIntFormat>(input, output, consumed);
+}
+
+/*
+ *  TranscodeSignedToCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeSignedToCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeSignedToCBORSize(std::span<const std::uint8_t> input,
+                                      std::size_t &consumed)
+{
+    return TranscodedSize<VarIntFormat, CBORIntFormat>(input, consumed);
+}
+
+/*
+ *  TranscodeSignedFromCBOR()
+ *
+ *  Description:
+ *      This function will convert a buffer containing a sequence of
+ *      CBOR major type 0 or 1 data items into the same sequence of
+ *      signed integers serialized as would be done by Serialize().
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      output [out]
+ *          The buffer into which to write the transcoded integers.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully transcoded.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets written to the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      Integers outside the range of std::int64_t and other data items
+ *      cannot be represented and result in an error.
+ */
+std::size_t TranscodeSignedFromCBOR(std::span<const std::uint8_t> input,
+                                    std::span<std::uint8_t> output,
+                                    std::size_t &consumed)
+{
+    return Transcode<CBORIntFormat, VarIntFormat>(input, output, consumed);
+}
+
+/*
+ *  TranscodeSignedFromCBORSize()
+ *
+ *  Description:
+ *      This function will determine the exact number of octets that
+ *      TranscodeSignedFromCBOR() will write for the given input buffer.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The buffer containing the integers to transcode.
+ *
+ *      consumed [out]
+ *          The number of input octets successfully examined.  On error,
+ *          this is the offset of the integer that could not be transcoded.
+ *
+ *  Returns:
+ *      The number of octets required for the output buffer, or zero if
+ *      there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t TranscodeSignedFromCBORSize(std::span<const std::uint8_t> input,
+                                        std::size_t &consumed)
+{
+    return TranscodedSize<CBORIntFormat, VarIntFormat>(input, consumed);
+}
+
+} // namespace VarIntEncoder
@@ -0,0 +1,31 @@
+/*
+ *  test_values.h
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This file defines functions shared by the test modules that produce
+ *      sequences of test values.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Produce bits that differ widely from one index to the next
+inline std::uint64_t TestBits(std::size_t i)
+{
+    return std::uint64_t(i) * 0x9e3779b97f4a7c15;
+}
+
+// Produce a sequence of values having a mix of serialized lengths
+inline std::uint64_t TestValue(std::size_t i)
+{
+    return TestBits(i) >> (i % 64);
+}
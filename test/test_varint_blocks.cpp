@@ -0,0 +1,250 @@
+/*
+ *  test_varint_blocks.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the functions that serialize integers in
+ *      blocks with summaries and that scan the serialized integers for
+ *      values within a range.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+#include <varint_encoder.h>
+#include <varint_blocks.h>
+#include <stf/stf.h>
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// Find the values in the given range by examining every value
+template<typename T>
+std::vector<T> Filter(const std::vector<T> &values, T low, T high)
+{
+    std::vector<T> matches;
+
+    for (T value : values)
+    {
+        if ((value >= low) && (value <= high)) matches.push_back(value);
+    }
+
+    return matches;
+}
+
+} // anonymous namespace
+
+STF_TEST(Blocks, SerializeBlocks)
+{
+    std::vector<std::uint64_t> values;
+    std::vector<std::uint8_t> buffer(10000);
+    std::vector<std::uint8_t> expected(10000);
+    std::vector<BlockSummary<std::uint64_t>> summaries;
+
+    for (std::uint64_t i = 0; i < 1000; i++) values.push_back(i * i);
+
+    // The serialized data is identical to that of the batch Serialize()
+    std::size_t length = SerializeBlocks(buffer, values, 64, summaries);
+    STF_ASSERT_NE(0, length);
+    STF_ASSERT_EQ(Serialize(expected, std::span<const std::uint64_t>(values)),
+                  length);
+    STF_ASSERT_TRUE(std::equal(buffer.begin(),
+                               buffer.begin() + length,
+                               expected.begin()));
+
+    // Each block is described by its summary
+    STF_ASSERT_EQ(16, summaries.size());
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < summaries.size(); i++)
+    {
+        std::uint64_t first = i * 64;
+        std::uint64_t last = std::min<std::uint64_t>(first + 63, 999);
+
+        STF_ASSERT_EQ(first * first, summaries[i].min);
+        STF_ASSERT_EQ(last * last, summaries[i].max);
+        STF_ASSERT_EQ(last - first + 1, summaries[i].count);
+        STF_ASSERT_EQ(offset, summaries[i].offset);
+        offset += summaries[i].length;
+    }
+    STF_ASSERT_EQ(length, offset);
+
+    // Errors leave the summaries unchanged
+    STF_ASSERT_EQ(0, SerializeBlocks(buffer, values, 0, summaries));
+    STF_ASSERT_EQ(0, SerializeBlocks(std::span(buffer).first(100),
+                                     values,
+                                     64,
+                                     summaries));
+    STF_ASSERT_EQ(16, summaries.size());
+}
+
+STF_TEST(Blocks, ScanUnsigned)
+{
+    std::vector<std::uint64_t> values;
+    std::vector<std::uint8_t> buffer(100000);
+    std::vector<BlockSummary<std::uint64_t>> summaries;
+
+    // Mostly increasing values, as timestamps would be
+    for (std::uint64_t i = 0; i < 10000; i++)
+    {
+        values.push_back(1000000 + i * 100 + (i * 7919) % 250);
+    }
+    values[5000] = std::numeric_limits<std::uint64_t>::max();
+
+    std::size_t length = SerializeBlocks(buffer, values, 128, summaries);
+    STF_ASSERT_NE(0, length);
+    std::span<const std::uint8_t> data(buffer.data(), length);
+
+    struct { std::uint64_t low; std::uint64_t high; } ranges[] =
+    {
+        {0, std::numeric_limits<std::uint64_t>::max()},
+        {0, 999999},
+        {1200000, 1250000},
+        {1500000, 1500100},
+        {1600000, std::numeric_limits<std::uint64_t>::max()},
+        {5, 4}
+    };
+
+    for (auto range : ranges)
+    {
+        std::vector<std::uint64_t> matches;
+        STF_ASSERT_TRUE(
+            ScanRange(data, summaries, range.low, range.high, matches));
+        STF_ASSERT_EQ(Filter(values, range.low, range.high), matches);
+    }
+}
+
+STF_TEST(Blocks, ScanSigned)
+{
+    std::vector<std::int64_t> values;
+    std::vector<std::uint8_t> buffer(100000);
+    std::vector<BlockSummary<std::int64_t>> summaries;
+
+    for (std::int64_t i = 0; i < 5000; i++) values.push_back(i * 3 - 7500);
+    values[100] = std::numeric_limits<std::int64_t>::min();
+    values[4000] = std::numeric_limits<std::int64_t>::max();
+
+    std::size_t length = SerializeBlocks(buffer, values, 100, summaries);
+    STF_ASSERT_NE(0, length);
+    std::span<const std::uint8_t> data(buffer.data(), length);
+
+    struct { std::int64_t low; std::int64_t high; } ranges[] =
+    {
+        {std::numeric_limits<std::int64_t>::min(), -7000},
+        {-100, 100},
+        {0, std::numeric_limits<std::int64_t>::max()},
+        {7000, 8000}
+    };
+
+    for (auto range : ranges)
+    {
+        std::vector<std::int64_t> matches;
+        STF_ASSERT_TRUE(
+            ScanRange(data, summaries, range.low, range.high, matches));
+        STF_ASSERT_EQ(Filter(values, range.low, range.high), matches);
+    }
+}
+
+STF_TEST(Blocks, ScanSkipsBlocks)
+{
+    std::vector<std::uint64_t> values;
+    std::vector<std::uint8_t> buffer(10000);
+    std::vector<BlockSummary<std::uint64_t>> summaries;
+
+    for (std::uint64_t i = 0; i < 1000; i++) values.push_back(i);
+
+    std::size_t length = SerializeBlocks(buffer, values, 100, summaries);
+    STF_ASSERT_NE(0, length);
+    std::span<const std::uint8_t> data(buffer.data(), length);
+
+    // Corrupt every block other than the fifth; since those blocks are
+    // skipped, the scan is unaffected
+    for (std::size_t i = 0; i < summaries.size(); i++)
+    {
+        if (i != 4)
+        {
+            buffer[summaries[i].offset + summaries[i].length - 1] = 0x80;
+        }
+    }
+
+    std::vector<std::uint64_t> matches;
+    STF_ASSERT_TRUE(ScanRange(data, summaries, 420, 430, matches));
+    STF_ASSERT_EQ(Filter<std::uint64_t>(values, 420, 430), matches);
+
+    // Scanning a corrupt block is an error
+    matches.clear();
+    STF_ASSERT_FALSE(ScanRange(data, summaries, 420, 530, matches));
+
+    // A block outside of the data is an error
+    matches.clear();
+    STF_ASSERT_FALSE(ScanRange(data.first(summaries[4].offset + 1),
+                               summaries,
+                               420,
+                               430,
+                               matches));
+}
+
+STF_TEST(Blocks, SerializeSummaries)
+{
+    std::vector<std::int64_t> values;
+    std::vector<std::uint8_t> buffer(10000);
+    std::vector<std::uint8_t> summary_buffer(1000);
+    std::vector<BlockSummary<std::int64_t>> summaries;
+    std::vector<BlockSummary<std::int64_t>> summaries2;
+
+    for (std::int64_t i = 0; i < 1000; i++) values.push_back(i * 37 - 1000);
+    values[999] = std::numeric_limits<std::int64_t>::min();
+    values[998] = std::numeric_limits<std::int64_t>::max();
+
+    STF_ASSERT_NE(0, SerializeBlocks(buffer, values, 64, summaries));
+
+    std::size_t length = SerializeSummaries(summary_buffer, summaries);
+    STF_ASSERT_NE(0, length);
+    STF_ASSERT_EQ(length,
+                  DeserializeSummaries(std::span(summary_buffer).first(length),
+                                       summaries2));
+    STF_ASSERT_EQ(summaries.size(), summaries2.size());
+    for (std::size_t i = 0; i < summaries.size(); i++)
+    {
+        STF_ASSERT_EQ(summaries[i].min, summaries2[i].min);
+        STF_ASSERT_EQ(summaries[i].max, summaries2[i].max);
+        STF_ASSERT_EQ(summaries[i].count, summaries2[i].count);
+        STF_ASSERT_EQ(summaries[i].offset, summaries2[i].offset);
+        STF_ASSERT_EQ(summaries[i].length, summaries2[i].length);
+    }
+
+    // Truncated summaries are rejected and leave the vector unchanged
+    STF_ASSERT_EQ(0,
+                  DeserializeSummaries(
+                      std::span(summary_buffer).first(length - 1),
+                      summaries2));
+    STF_ASSERT_EQ(summaries.size(), summaries2.size());
+
+    // Blocks must follow one another
+    summaries[1].offset++;
+    STF_ASSERT_EQ(0, SerializeSummaries(summary_buffer, summaries));
+
+    // A block whose length is impossible for its count is rejected
+    std::vector<BlockSummary<std::uint64_t>> unsigned_summaries;
+    std::uint8_t invalid[] = {0x01, 0x02, 0x15, 0x00, 0x00};
+    STF_ASSERT_EQ(0, DeserializeSummaries(invalid, unsigned_summaries));
+    invalid[2] = 0x14;
+    STF_ASSERT_EQ(5, DeserializeSummaries(invalid, unsigned_summaries));
+    STF_ASSERT_EQ(1, unsigned_summaries.size());
+
+    // An empty set of summaries may be serialized
+    unsigned_summaries.clear();
+    STF_ASSERT_EQ(1, SerializeSummaries(summary_buffer, unsigned_summaries));
+    STF_ASSERT_EQ(1, DeserializeSummaries(std::span(summary_buffer).first(1),
+                                          unsigned_summaries));
+    STF_ASSERT_TRUE(unsigned_summaries.empty());
+}
@@ -0,0 +1,309 @@
+/*
+ *  test_varint_dispatch.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the functions that serialize and
+ *      deserialize many integers at once, verifying that every kernel tier
+ *      supported by the processor produces results identical to those
+ *      produced by calling Serialize() and Deserialize() for each value.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+#include <varint_encoder.h>
+#include <varint_dispatch.h>
+#include <stf/stf.h>
+#include "test_values.h"
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// All kernel tiers
+constexpr KernelTier Kernel_Tiers[] = {KernelTier::Scalar, KernelTier::AVX512};
+
+// Produce a sequence of values having a mix of serialized lengths, with
+// runs of values no longer than 8 octets so that vectorized paths are used
+std::uint64_t VectorTestValue(std::size_t i)
+{
+    if ((i / 64) % 2) return TestBits(i) >> (8 + i % 57);
+
+    return TestValue(i);
+}
+
+// Serialize the values individually using the reference implementation
+template<typename T>
+std::vector<std::uint8_t> SerializeReference(const std::vector<T> &values)
+{
+    std::vector<std::uint8_t> buffer(values.size() * 10);
+    std::size_t position = 0;
+
+    for (T value : values)
+    {
+        position += Serialize(std::span(buffer).subspan(position), value);
+    }
+    buffer.resize(position);
+
+    return buffer;
+}
+
+// Verify that the given tier serializes and deserializes the values
+template<typename T>
+void VerifyTier(KernelTier tier, const std::vector<T> &values)
+{
+    std::vector<std::uint8_t> expected = SerializeReference(values);
+
+    STF_ASSERT_TRUE(SetKernelTier(tier));
+    STF_ASSERT_TRUE(GetKernelTier() == tier);
+
+    // Serialize into a buffer having room to spare
+    std::vector<std::uint8_t> buffer(expected.size() + 100, 0x22);
+    STF_ASSERT_EQ(expected.size(),
+                  Serialize(buffer, std::span<const T>(values)));
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        STF_ASSERT_EQ(expected[i], buffer[i]);
+    }
+
+    // Octets beyond the serialized integers must not be modified
+    for (std::size_t i = expected.size(); i < buffer.size(); i++)
+    {
+        STF_ASSERT_EQ(0x22, buffer[i]);
+    }
+
+    // Serialize into a buffer of exactly the required size
+    buffer.resize(expected.size());
+    STF_ASSERT_EQ(expected.size(),
+                  Serialize(buffer, std::span<const T>(values)));
+    STF_ASSERT_EQ(expected, buffer);
+
+    // A buffer one octet too small must fail
+    if (!values.empty())
+    {
+        buffer.pop_back();
+        STF_ASSERT_EQ(0, Serialize(buffer, std::span<const T>(values)));
+    }
+
+    // Deserialize the values
+    std::vector<T> values2(values.size());
+    STF_ASSERT_EQ(expected.size(), Deserialize(expected, std::span(values2)));
+    STF_ASSERT_EQ(values, values2);
+
+    // Trailing data is not consumed
+    expected.resize(expected.size() + 100, 0x01);
+    STF_ASSERT_EQ(expected.size() - 100,
+                  Deserialize(expected, std::span(values2)));
+    STF_ASSERT_EQ(values, values2);
+
+    // Truncated data must fail
+    if (!values.empty())
+    {
+        expected.resize(expected.size() - 101);
+        STF_ASSERT_EQ(0, Deserialize(expected, std::span(values2)));
+    }
+}
+
+} // anonymous namespace
+
+STF_TEST(Dispatch, TierNames)
+{
+    STF_ASSERT_TRUE(IsKernelTierSupported(KernelTier::Scalar));
+    STF_ASSERT_EQ(std::string("scalar"),
+                  GetKernelTierName(KernelTier::Scalar));
+    STF_ASSERT_EQ(std::string("avx512"),
+                  GetKernelTierName(KernelTier::AVX512));
+}
+
+STF_TEST(Dispatch, EnvironmentOverride)
+{
+    // This test is also run by CTest with VARINT_ENCODER_TIER set to each
+    // tier name and to an unknown name; every other test restores the tier
+    // it found, so the tier in use is that selected on first use
+    KernelTier expected = KernelTier::Scalar;
+    for (KernelTier tier : Kernel_Tiers)
+    {
+        if (IsKernelTierSupported(tier)) expected = tier;
+    }
+
+    // The environment may only force a lower tier than that supported;
+    // naming a higher tier or an unknown tier has no effect
+    const char *name = std::getenv("VARINT_ENCODER_TIER");
+    if (name != nullptr)
+    {
+        for (KernelTier tier : Kernel_Tiers)
+        {
+            if ((std::string(name) == GetKernelTierName(tier)) &&
+                (tier < expected))
+            {
+                expected = tier;
+            }
+        }
+    }
+
+    STF_ASSERT_TRUE(GetKernelTier() == expected);
+}
+
+STF_TEST(Dispatch, UnsignedValues)
+{
+    KernelTier original_tier = GetKernelTier();
+
+    for (std::size_t count : {0, 1, 7, 8, 9, 63, 64, 65, 5000})
+    {
+        std::vector<std::uint64_t> values;
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values.push_back(VectorTestValue(i));
+        }
+        if (count > 2) values[count / 2] = 0;
+        if (count > 3) values[count / 3] =
+            std::numeric_limits<std::uint64_t>::max();
+
+        for (KernelTier tier : Kernel_Tiers)
+        {
+            if (IsKernelTierSupported(tier)) VerifyTier(tier, values);
+        }
+    }
+
+    STF_ASSERT_TRUE(SetKernelTier(original_tier));
+}
+
+STF_TEST(Dispatch, SignedValues)
+{
+    KernelTier original_tier = GetKernelTier();
+
+    for (std::size_t count : {0, 1, 7, 8, 9, 63, 64, 65, 5000})
+    {
+        std::vector<std::int64_t> values;
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::int64_t value = static_cast<std::int64_t>(VectorTestValue(i));
+            values.push_back((i % 3) ? value : -value);
+        }
+        if (count > 2) values[count / 2] =
+            std::numeric_limits<std::int64_t>::min();
+        if (count > 3) values[count / 3] =
+            std::numeric_limits<std::int64_t>::max();
+
+        for (KernelTier tier : Kernel_Tiers)
+        {
+            if (IsKernelTierSupported(tier)) VerifyTier(tier, values);
+        }
+    }
+
+    STF_ASSERT_TRUE(SetKernelTier(original_tier));
+}
+
+STF_TEST(Dispatch, InvalidData)
+{
+    KernelTier original_tier = GetKernelTier();
+    std::vector<std::uint64_t> values(16);
+
+    // An integer longer than 10 octets within otherwise valid data
+    std::vector<std::uint8_t> buffer(128, 0x01);
+    for (std::size_t i = 10; i < 21; i++) buffer[i] = 0xff;
+
+    for (KernelTier tier : Kernel_Tiers)
+    {
+        if (!IsKernelTierSupported(tier)) continue;
+
+        STF_ASSERT_TRUE(SetKernelTier(tier));
+        STF_ASSERT_EQ(0, Deserialize(buffer, std::span(values)));
+    }
+
+    STF_ASSERT_TRUE(SetKernelTier(original_tier));
+}
+
+#if defined(__SIZEOF_INT128__)
+
+namespace
+{
+
+// Verify the batch functions for 128-bit values against Deserialize() and
+// Serialize() called for each value
+template<typename T>
+void Verify128(const std::vector<T> &values)
+{
+    std::vector<std::uint8_t> expected(values.size() * 19);
+    std::size_t position = 0;
+
+    for (T value : values)
+    {
+        position += Serialize(std::span(expected).subspan(position), value);
+    }
+    expected.resize(position);
+
+    std::vector<std::uint8_t> buffer(expected.size());
+    STF_ASSERT_EQ(expected.size(),
+                  Serialize(buffer, std::span<const T>(values)));
+    STF_ASSERT_EQ(expected, buffer);
+
+    // A buffer one octet too small must fail
+    if (!values.empty())
+    {
+        buffer.pop_back();
+        STF_ASSERT_EQ(0, Serialize(buffer, std::span<const T>(values)));
+    }
+
+    std::vector<T> values2(values.size());
+    STF_ASSERT_EQ(expected.size(), Deserialize(expected, std::span(values2)));
+    STF_ASSERT_TRUE(values == values2);
+
+    // Truncated data must fail
+    if (!values.empty())
+    {
+        expected.pop_back();
+        STF_ASSERT_EQ(0, Deserialize(expected, std::span(values2)));
+    }
+}
+
+} // anonymous namespace
+
+STF_TEST(Dispatch, Values128)
+{
+    KernelTier original_tier = GetKernelTier();
+
+    for (std::size_t count : {0, 1, 63, 64, 65, 1000})
+    {
+        std::vector<uint128_t> unsigned_values;
+        std::vector<int128_t> signed_values;
+
+        // Mostly values having a zero high word, with occasional large ones
+        for (std::size_t i = 0; i < count; i++)
+        {
+            uint128_t value = VectorTestValue(i);
+            if (i % 37 == 5) value |= uint128_t(VectorTestValue(i + 1)) << 64;
+            if (i % 101 == 7) value = ~uint128_t(0);
+
+            unsigned_values.push_back(value);
+            signed_values.push_back((i % 3) ? int128_t(value) :
+                                              -int128_t(value >> 1));
+        }
+
+        for (KernelTier tier : Kernel_Tiers)
+        {
+            if (!IsKernelTierSupported(tier)) continue;
+
+            STF_ASSERT_TRUE(SetKernelTier(tier));
+            Verify128(unsigned_values);
+            Verify128(signed_values);
+        }
+    }
+
+    STF_ASSERT_TRUE(SetKernelTier(original_tier));
+}
+
+#endif // __SIZEOF_INT128__
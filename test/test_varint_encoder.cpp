@@ -489,3 +489,350 @@ STF_TEST(VariableEncoder, TestTooBig)
     // Zero should be returned indicating failure
     STF_ASSERT_EQ(0, Deserialize(buffer, value));
 }
+
+STF_TEST(VariableEncoder, EncodeUnsignedPadded)
+{
+    std::uint64_t value;
+    std::array<std::uint8_t, 128> buffer;
+
+    // Initialize the buffer
+    for (std::size_t i = 0; i < buffer.size(); i++) buffer[i] = 0x22;
+
+    // Reserve three octets for a small value
+    STF_ASSERT_EQ(3, Serialize(buffer, std::uint64_t(1), 3));
+    STF_ASSERT_EQ(0x80, buffer[0]);
+    STF_ASSERT_EQ(0x80, buffer[1]);
+    STF_ASSERT_EQ(0x01, buffer[2]);
+    STF_ASSERT_EQ(0x22, buffer[3]); // Should have no data
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(1, value);
+
+    // A minimum smaller than required has no effect
+    STF_ASSERT_EQ(2, Serialize(buffer, std::uint64_t(0x3fff), 1));
+    STF_ASSERT_EQ(0xff, buffer[0]);
+    STF_ASSERT_EQ(0x7f, buffer[1]);
+
+    // Values may be padded to 10 octets, but no further
+    STF_ASSERT_EQ(10, Serialize(buffer, std::uint64_t(0), 10));
+    for (std::size_t i = 0; i < 9; i++) STF_ASSERT_EQ(0x80, buffer[i]);
+    STF_ASSERT_EQ(0x00, buffer[9]);
+    STF_ASSERT_EQ(10, Deserialize(buffer, value));
+    STF_ASSERT_EQ(0, value);
+    STF_ASSERT_EQ(0, Serialize(buffer, std::uint64_t(0), 11));
+
+    // Buffer too small for the padded integer
+    STF_ASSERT_EQ(0,
+                  Serialize(std::span(buffer).first(4), std::uint64_t(1), 5));
+
+    // Rewrite the reserved integer in place
+    STF_ASSERT_EQ(3, Serialize(buffer, std::uint64_t(0), 3));
+    buffer[3] = 0x55;
+    STF_ASSERT_EQ(3, Rewrite(buffer, std::uint64_t(300)));
+    STF_ASSERT_EQ(0x80, buffer[0]);
+    STF_ASSERT_EQ(0x82, buffer[1]);
+    STF_ASSERT_EQ(0x2c, buffer[2]);
+    STF_ASSERT_EQ(0x55, buffer[3]); // Should be unchanged
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(300, value);
+
+    // The largest value fitting in the slot
+    STF_ASSERT_EQ(3, Rewrite(buffer, std::uint64_t(0x1fffff)));
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(0x1fffff, value);
+
+    // A value too large for the slot leaves the buffer unchanged
+    STF_ASSERT_EQ(0, Rewrite(buffer, std::uint64_t(0x200000)));
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(0x1fffff, value);
+
+    // The buffer must begin with a valid integer
+    STF_ASSERT_EQ(0, Rewrite(std::span(buffer).first(2), std::uint64_t(1)));
+}
+
+STF_TEST(VariableEncoder, EncodeSignedPadded)
+{
+    std::int64_t value;
+    std::array<std::uint8_t, 128> buffer;
+
+    // Initialize the buffer
+    for (std::size_t i = 0; i < buffer.size(); i++) buffer[i] = 0x22;
+
+    // Non-negative values are padded using 0x80 octets
+    STF_ASSERT_EQ(3, Serialize(buffer, std::int64_t(5), 3));
+    STF_ASSERT_EQ(0x80, buffer[0]);
+    STF_ASSERT_EQ(0x80, buffer[1]);
+    STF_ASSERT_EQ(0x05, buffer[2]);
+    STF_ASSERT_EQ(0x22, buffer[3]); // Should have no data
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(5, value);
+
+    // Negative values are padded using 0xff octets
+    STF_ASSERT_EQ(3, Serialize(buffer, std::int64_t(-5), 3));
+    STF_ASSERT_EQ(0xff, buffer[0]);
+    STF_ASSERT_EQ(0xff, buffer[1]);
+    STF_ASSERT_EQ(0x7b, buffer[2]);
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(-5, value);
+
+    // Values may be padded to 10 octets, but no further
+    STF_ASSERT_EQ(10, Serialize(buffer, std::int64_t(-1), 10));
+    STF_ASSERT_EQ(10, Deserialize(buffer, value));
+    STF_ASSERT_EQ(-1, value);
+    STF_ASSERT_EQ(10, Serialize(buffer, std::int64_t(1), 10));
+    STF_ASSERT_EQ(10, Deserialize(buffer, value));
+    STF_ASSERT_EQ(1, value);
+    STF_ASSERT_EQ(0, Serialize(buffer, std::int64_t(1), 11));
+
+    // Rewrite the integer in place, changing its sign
+    STF_ASSERT_EQ(10, Rewrite(buffer, std::int64_t(-8192)));
+    STF_ASSERT_EQ(10, Deserialize(buffer, value));
+    STF_ASSERT_EQ(-8192, value);
+    STF_ASSERT_EQ(3, Serialize(buffer, std::int64_t(0), 3));
+    STF_ASSERT_EQ(3, Rewrite(buffer, std::int64_t(-1048576)));
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(-1048576, value);
+
+    // A value too large for the slot leaves the buffer unchanged
+    STF_ASSERT_EQ(0, Rewrite(buffer, std::int64_t(1048576)));
+    STF_ASSERT_EQ(3, Deserialize(buffer, value));
+    STF_ASSERT_EQ(-1048576, value);
+}
+
+STF_TEST(VariableEncoder, EncodeUnsignedLEB128)
+{
+    std::uint64_t value;
+    std::uint64_t value2;
+    std::array<std::uint8_t, 128> buffer;
+
+    // Initialize the buffer
+    for (std::size_t i = 0; i < buffer.size(); i++) buffer[i] = 0x22;
+
+    // Single octet test
+    value = 0x01;
+    STF_ASSERT_EQ(1, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0x01, buffer[0]);
+    STF_ASSERT_EQ(0x22, buffer[1]); // Should have no data
+    STF_ASSERT_EQ(1, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    // Two octet tests (examples from the Protocol Buffers documentation)
+    value = 150;
+    STF_ASSERT_EQ(2, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0x96, buffer[0]);
+    STF_ASSERT_EQ(0x01, buffer[1]);
+    STF_ASSERT_EQ(0x22, buffer[2]); // Should have no data
+    STF_ASSERT_EQ(2, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    value = 300;
+    STF_ASSERT_EQ(2, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0xac, buffer[0]);
+    STF_ASSERT_EQ(0x02, buffer[1]);
+    STF_ASSERT_EQ(0x22, buffer[2]); // Should have no data
+    STF_ASSERT_EQ(2, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    // Ten octet test
+    value = std::numeric_limits<std::uint64_t>::max();
+    STF_ASSERT_EQ(10, SerializeLEB128(buffer, value));
+    for (std::size_t i = 0; i < 9; i++) STF_ASSERT_EQ(0xff, buffer[i]);
+    STF_ASSERT_EQ(0x01, buffer[9]);
+    STF_ASSERT_EQ(0x22, buffer[10]); // Should have no data
+    STF_ASSERT_EQ(10, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    // A final octet carrying more than bit 63 is invalid
+    buffer[9] = 0x02;
+    STF_ASSERT_EQ(0, DeserializeLEB128(buffer, value2));
+
+    // Buffer too small
+    STF_ASSERT_EQ(0, SerializeLEB128(std::span(buffer).first(9), value));
+    STF_ASSERT_EQ(0, DeserializeLEB128(std::span(buffer).first(1), value2));
+}
+
+STF_TEST(VariableEncoder, EncodeSignedLEB128)
+{
+    std::int64_t value;
+    std::int64_t value2;
+    std::array<std::uint8_t, 128> buffer;
+
+    // Initialize the buffer
+    for (std::size_t i = 0; i < buffer.size(); i++) buffer[i] = 0x22;
+
+    value = -1;
+    STF_ASSERT_EQ(1, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0x7f, buffer[0]);
+    STF_ASSERT_EQ(0x22, buffer[1]); // Should have no data
+    STF_ASSERT_EQ(1, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    value = 64;
+    STF_ASSERT_EQ(2, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0xc0, buffer[0]);
+    STF_ASSERT_EQ(0x00, buffer[1]);
+    STF_ASSERT_EQ(0x22, buffer[2]); // Should have no data
+    STF_ASSERT_EQ(2, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    value = -129;
+    STF_ASSERT_EQ(2, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0xff, buffer[0]);
+    STF_ASSERT_EQ(0x7e, buffer[1]);
+    STF_ASSERT_EQ(0x22, buffer[2]); // Should have no data
+    STF_ASSERT_EQ(2, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    // Test smallest signed integer
+    value = std::numeric_limits<std::int64_t>::min();
+    STF_ASSERT_EQ(10, SerializeLEB128(buffer, value));
+    for (std::size_t i = 0; i < 9; i++) STF_ASSERT_EQ(0x80, buffer[i]);
+    STF_ASSERT_EQ(0x7f, buffer[9]);
+    STF_ASSERT_EQ(0x22, buffer[10]); // Should have no data
+    STF_ASSERT_EQ(10, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    // Test largest signed integer
+    value = std::numeric_limits<std::int64_t>::max();
+    STF_ASSERT_EQ(10, SerializeLEB128(buffer, value));
+    STF_ASSERT_EQ(0x00, buffer[9]);
+    STF_ASSERT_EQ(10, DeserializeLEB128(buffer, value2));
+    STF_ASSERT_EQ(value, value2);
+
+    // A final octet that is not a sign extension is invalid
+    buffer[9] = 0x01;
+    STF_ASSERT_EQ(0, DeserializeLEB128(buffer, value2));
+}
+
+#if defined(__SIZEOF_INT128__)
+
+STF_TEST(VariableEncoder, EncodeUnsigned128)
+{
+    uint128_t value;
+    uint128_t value2;
+    std::array<std::uint8_t, 128> buffer;
+
+    // Initialize the buffer
+    for (std::size_t i = 0; i < buffer.size(); i++) buffer[i] = 0x22;
+
+    // Values fitting in 64 bits serialize as 64-bit values do
+    value = 0x3fff;
+    STF_ASSERT_EQ(2, Serialize(buffer, value));
+    STF_ASSERT_EQ(0xff, buffer[0]);
+    STF_ASSERT_EQ(0x7f, buffer[1]);
+    STF_ASSERT_EQ(0x22, buffer[2]); // Should have no data
+    STF_ASSERT_EQ(2, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    value = std::numeric_limits<std::uint64_t>::max();
+    STF_ASSERT_EQ(10, Serialize(buffer, value));
+    STF_ASSERT_EQ(0x81, buffer[0]);
+    STF_ASSERT_EQ(10, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // Smallest value requiring more than 64 bits
+    value = uint128_t(1) << 64;
+    STF_ASSERT_EQ(10, Serialize(buffer, value));
+    STF_ASSERT_EQ(0x82, buffer[0]);
+    for (std::size_t i = 1; i < 9; i++) STF_ASSERT_EQ(0x80, buffer[i]);
+    STF_ASSERT_EQ(0x00, buffer[9]);
+    STF_ASSERT_EQ(0x22, buffer[10]); // Should have no data
+    STF_ASSERT_EQ(10, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // That is not a valid 64-bit value
+    std::uint64_t value64;
+    STF_ASSERT_EQ(0, Deserialize(buffer, value64));
+
+    // Largest value
+    value = std::numeric_limits<uint128_t>::max();
+    STF_ASSERT_EQ(19, Serialize(buffer, value));
+    STF_ASSERT_EQ(0x83, buffer[0]);
+    for (std::size_t i = 1; i < 18; i++) STF_ASSERT_EQ(0xff, buffer[i]);
+    STF_ASSERT_EQ(0x7f, buffer[18]);
+    STF_ASSERT_EQ(0x22, buffer[19]); // Should have no data
+    STF_ASSERT_EQ(19, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // Buffer too small
+    STF_ASSERT_EQ(0, Serialize(std::span(buffer).first(18), value));
+    STF_ASSERT_EQ(0, Deserialize(std::span(buffer).first(18), value2));
+
+    // A 19-octet value must have an initial octet of 0x80 .. 0x83
+    buffer[0] = 0x84;
+    STF_ASSERT_EQ(0, Deserialize(buffer, value2));
+    buffer[0] = 0x80;
+    STF_ASSERT_EQ(19, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE((value >> 2) == value2);
+
+    // No value may be 20 octets
+    std::array<std::uint8_t, 20> too_big;
+    for (std::size_t i = 0; i < 19; i++) too_big[i] = 0x80;
+    too_big[19] = 0x00;
+    STF_ASSERT_EQ(0, Deserialize(too_big, value2));
+}
+
+STF_TEST(VariableEncoder, EncodeSigned128)
+{
+    int128_t value;
+    int128_t value2;
+    std::array<std::uint8_t, 128> buffer;
+
+    // Initialize the buffer
+    for (std::size_t i = 0; i < buffer.size(); i++) buffer[i] = 0x22;
+
+    // Values fitting in 64 bits serialize as 64-bit values do
+    value = -8193;
+    STF_ASSERT_EQ(3, Serialize(buffer, value));
+    STF_ASSERT_EQ(0xff, buffer[0]);
+    STF_ASSERT_EQ(0xbf, buffer[1]);
+    STF_ASSERT_EQ(0x7f, buffer[2]);
+    STF_ASSERT_EQ(0x22, buffer[3]); // Should have no data
+    STF_ASSERT_EQ(3, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    value = std::numeric_limits<std::int64_t>::min();
+    STF_ASSERT_EQ(10, Serialize(buffer, value));
+    STF_ASSERT_EQ(0xff, buffer[0]);
+    STF_ASSERT_EQ(10, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // Values just beyond the 64-bit range
+    value = int128_t(std::numeric_limits<std::int64_t>::min()) - 1;
+    STF_ASSERT_EQ(10, Serialize(buffer, value));
+    STF_ASSERT_EQ(0xfe, buffer[0]);
+    STF_ASSERT_EQ(10, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    value = int128_t(std::numeric_limits<std::int64_t>::max()) + 1;
+    STF_ASSERT_EQ(10, Serialize(buffer, value));
+    STF_ASSERT_EQ(0x81, buffer[0]);
+    STF_ASSERT_EQ(10, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // Smallest value
+    value = std::numeric_limits<int128_t>::min();
+    STF_ASSERT_EQ(19, Serialize(buffer, value));
+    STF_ASSERT_EQ(0xfe, buffer[0]);
+    for (std::size_t i = 1; i < 18; i++) STF_ASSERT_EQ(0x80, buffer[i]);
+    STF_ASSERT_EQ(0x00, buffer[18]);
+    STF_ASSERT_EQ(0x22, buffer[19]); // Should have no data
+    STF_ASSERT_EQ(19, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // Largest value
+    value = std::numeric_limits<int128_t>::max();
+    STF_ASSERT_EQ(19, Serialize(buffer, value));
+    STF_ASSERT_EQ(0x81, buffer[0]);
+    for (std::size_t i = 1; i < 18; i++) STF_ASSERT_EQ(0xff, buffer[i]);
+    STF_ASSERT_EQ(0x7f, buffer[18]);
+    STF_ASSERT_EQ(19, Deserialize(buffer, value2));
+    STF_ASSERT_TRUE(value == value2);
+
+    // A 19-octet value must have one of four initial octets
+    buffer[0] = 0x82;
+    STF_ASSERT_EQ(0, Deserialize(buffer, value2));
+    buffer[0] = 0xfd;
+    STF_ASSERT_EQ(0, Deserialize(buffer, value2));
+}
+
+#endif // __SIZEOF_INT128__
@@ -0,0 +1,217 @@
+/*
+ *  test_varint_record.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the RecordSchema template, verifying
+ *      that records are serialized exactly as the individual members
+ *      would be serialized using Serialize().
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+#include <varint_encoder.h>
+#include <varint_record.h>
+#include <stf/stf.h>
+#include "test_values.h"
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+struct Message
+{
+    std::uint32_t id;
+    std::int64_t delta;
+    std::uint8_t flags;
+    std::int16_t offset;
+    std::uint64_t timestamp;
+};
+
+using MessageSchema = RecordSchema<Message,
+                                   &Message::id,
+                                   &Message::delta,
+                                   &Message::flags,
+                                   &Message::offset,
+                                   &Message::timestamp>;
+
+static_assert(MessageSchema::Max_Size == 5 + 10 + 2 + 3 + 10);
+
+// Produce a test record
+Message TestMessage(std::size_t i)
+{
+    std::uint64_t bits = TestBits(i);
+
+    return {static_cast<std::uint32_t>(bits >> (i % 32)),
+            static_cast<std::int64_t>(bits) >> (i % 64),
+            static_cast<std::uint8_t>(i),
+            static_cast<std::int16_t>(bits >> 48),
+            bits >> (63 - i % 64)};
+}
+
+// Serialize the members of a record individually
+std::size_t SerializeMembers(std::span<std::uint8_t> buffer,
+                             const Message &message)
+{
+    std::size_t length = 0;
+
+    length += Serialize(buffer.subspan(length), std::uint64_t(message.id));
+    length += Serialize(buffer.subspan(length), std::int64_t(message.delta));
+    length += Serialize(buffer.subspan(length), std::uint64_t(message.flags));
+    length += Serialize(buffer.subspan(length), std::int64_t(message.offset));
+    length += Serialize(buffer.subspan(length), message.timestamp);
+
+    return length;
+}
+
+bool operator==(const Message &a, const Message &b)
+{
+    return (a.id == b.id) && (a.delta == b.delta) && (a.flags == b.flags) &&
+           (a.offset == b.offset) && (a.timestamp == b.timestamp);
+}
+
+} // anonymous namespace
+
+STF_TEST(RecordSchema, SingleRecord)
+{
+    std::array<std::uint8_t, 64> buffer;
+    std::array<std::uint8_t, 64> expected;
+
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        Message message = TestMessage(i);
+        Message message2{};
+
+        std::size_t length = SerializeMembers(expected, message);
+        STF_ASSERT_EQ(length, MessageSchema::Serialize(buffer, message));
+        STF_ASSERT_TRUE(std::equal(expected.begin(),
+                                   expected.begin() + length,
+                                   buffer.begin()));
+
+        STF_ASSERT_EQ(length, MessageSchema::Deserialize(buffer, message2));
+        STF_ASSERT_TRUE(message == message2);
+
+        // A buffer of exactly the required size suffices
+        std::span<std::uint8_t> exact = std::span(buffer).first(length);
+        STF_ASSERT_EQ(length, MessageSchema::Serialize(exact, message));
+        STF_ASSERT_EQ(length, MessageSchema::Deserialize(exact, message2));
+        STF_ASSERT_TRUE(message == message2);
+
+        // A buffer one octet too small does not
+        std::span<std::uint8_t> small = exact.first(length - 1);
+        STF_ASSERT_EQ(0, MessageSchema::Serialize(small, message));
+        STF_ASSERT_EQ(0, MessageSchema::Deserialize(small, message2));
+    }
+}
+
+STF_TEST(RecordSchema, MultipleRecords)
+{
+    std::vector<Message> messages;
+    std::vector<std::uint8_t> expected(MessageSchema::Max_Size * 500);
+    std::size_t expected_length = 0;
+
+    for (std::size_t i = 0; i < 500; i++)
+    {
+        messages.push_back(TestMessage(i));
+        expected_length +=
+            SerializeMembers(std::span(expected).subspan(expected_length),
+                             messages.back());
+    }
+    expected.resize(expected_length);
+
+    // Serialize into a buffer of exactly the required size
+    std::vector<std::uint8_t> buffer(expected_length);
+    STF_ASSERT_EQ(expected_length,
+                  MessageSchema::Serialize(
+                      buffer,
+                      std::span<const Message>(messages)));
+    STF_ASSERT_EQ(expected, buffer);
+
+    std::vector<Message> messages2(messages.size());
+    STF_ASSERT_EQ(expected_length,
+                  MessageSchema::Deserialize(buffer,
+                                             std::span<Message>(messages2)));
+    for (std::size_t i = 0; i < messages.size(); i++)
+    {
+        STF_ASSERT_TRUE(messages[i] == messages2[i]);
+    }
+
+    // Too few octets for the requested number of records
+    buffer.pop_back();
+    STF_ASSERT_EQ(0,
+                  MessageSchema::Serialize(
+                      buffer,
+                      std::span<const Message>(messages)));
+    STF_ASSERT_EQ(0,
+                  MessageSchema::Deserialize(buffer,
+                                             std::span<Message>(messages2)));
+}
+
+STF_TEST(RecordSchema, OutOfRange)
+{
+    struct Small
+    {
+        std::uint8_t a;
+        std::int8_t b;
+    };
+    using SmallSchema = RecordSchema<Small, &Small::a, &Small::b>;
+    std::array<std::uint8_t, 16> buffer{};
+    Small small{};
+
+    // 256 does not fit in a std::uint8_t
+    std::size_t length = Serialize(buffer, std::uint64_t(256));
+    Serialize(std::span(buffer).subspan(length), std::int64_t(0));
+    STF_ASSERT_EQ(0, SmallSchema::Deserialize(buffer, small));
+
+    // -129 does not fit in a std::int8_t
+    length = Serialize(buffer, std::uint64_t(255));
+    Serialize(std::span(buffer).subspan(length), std::int64_t(-129));
+    STF_ASSERT_EQ(0, SmallSchema::Deserialize(buffer, small));
+
+    // -128 does
+    Serialize(std::span(buffer).subspan(length), std::int64_t(-128));
+    STF_ASSERT_EQ(4, SmallSchema::Deserialize(buffer, small));
+    STF_ASSERT_EQ(255, small.a);
+    STF_ASSERT_EQ(-128, small.b);
+
+    // Unterminated integer
+    buffer.fill(0x81);
+    STF_ASSERT_EQ(0, SmallSchema::Deserialize(buffer, small));
+}
+
+STF_TEST(RecordSchema, Limits)
+{
+    struct Wide
+    {
+        std::uint64_t a;
+        std::int64_t b;
+        std::int64_t c;
+    };
+    using WideSchema = RecordSchema<Wide, &Wide::a, &Wide::b, &Wide::c>;
+    std::array<std::uint8_t, 32> buffer{};
+    Wide wide{std::numeric_limits<std::uint64_t>::max(),
+              std::numeric_limits<std::int64_t>::min(),
+              std::numeric_limits<std::int64_t>::max()};
+    Wide wide2{};
+
+    STF_ASSERT_EQ(30, WideSchema::Serialize(buffer, wide));
+    STF_ASSERT_EQ(30, WideSchema::Deserialize(buffer, wide2));
+    STF_ASSERT_EQ(wide.a, wide2.a);
+    STF_ASSERT_EQ(wide.b, wide2.b);
+    STF_ASSERT_EQ(wide.c, wide2.c);
+
+    // Leading octet carrying more than 64 bits
+    buffer[0] = 0x82;
+    STF_ASSERT_EQ(0, WideSchema::Deserialize(buffer, wide2));
+}
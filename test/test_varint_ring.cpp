@@ -0,0 +1,242 @@
+/*
+ *  test_varint_ring.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the SharedRing object, verifying that
+ *      records written into the ring are read back intact, both within a
+ *      single process and between two processes.
+ *
+ *  Portability Issues:
+ *      Requires a POSIX system.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <varint_encoder.h>
+#include <varint_ring.h>
+#include <stf/stf.h>
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// Produce the length of the given record, with a mix of sizes
+std::size_t RecordLength(std::size_t i)
+{
+    return (i % 7 == 0) ? (i * 31) % 1500 : i % 40;
+}
+
+// Produce the octet at the given offset of the given record
+std::uint8_t RecordOctet(std::size_t i, std::size_t offset)
+{
+    return static_cast<std::uint8_t>(i * 13 + offset);
+}
+
+// Write the given record into the ring using Reserve() and Commit()
+bool WriteRecord(SharedRing &ring, std::size_t i, bool wait)
+{
+    std::span<std::uint8_t> record;
+    std::size_t length = RecordLength(i);
+
+    bool reserved = wait ? ring.Reserve(length, record) :
+                           ring.TryReserve(length, record);
+    if (!reserved) return false;
+
+    for (std::size_t j = 0; j < length; j++) record[j] = RecordOctet(i, j);
+    ring.Commit();
+
+    return true;
+}
+
+// Verify the given record holds the expected contents
+bool VerifyRecord(std::span<const std::uint8_t> record, std::size_t i)
+{
+    if (record.size() != RecordLength(i)) return false;
+
+    for (std::size_t j = 0; j < record.size(); j++)
+    {
+        if (record[j] != RecordOctet(i, j)) return false;
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+STF_TEST(SharedRing, CreateAndAttach)
+{
+    SharedRing producer;
+    SharedRing consumer;
+
+    STF_ASSERT_FALSE(producer.IsOpen());
+    STF_ASSERT_TRUE(producer.Create(1000));
+    STF_ASSERT_TRUE(producer.IsOpen());
+    STF_ASSERT_GE(producer.Capacity(), 1000);
+    STF_ASSERT_EQ(0, producer.Capacity() & (producer.Capacity() - 1));
+
+    STF_ASSERT_TRUE(consumer.Attach(producer.FileDescriptor()));
+    STF_ASSERT_EQ(producer.Capacity(), consumer.Capacity());
+    STF_ASSERT_NE(producer.FileDescriptor(), consumer.FileDescriptor());
+
+    // Only a ring may be attached
+    int pipe_fds[2];
+    SharedRing other;
+    STF_ASSERT_EQ(0, pipe(pipe_fds));
+    STF_ASSERT_FALSE(other.Attach(pipe_fds[0]));
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    // A record too large for the ring is rejected
+    std::vector<std::uint8_t> large(producer.Capacity());
+    STF_ASSERT_FALSE(producer.Write(large));
+
+    // Empty records are allowed
+    std::span<const std::uint8_t> record;
+    STF_ASSERT_FALSE(consumer.TryRead(record));
+    STF_ASSERT_TRUE(producer.TryWrite({}));
+    STF_ASSERT_TRUE(consumer.TryRead(record));
+    STF_ASSERT_EQ(0, record.size());
+    STF_ASSERT_FALSE(consumer.TryRead(record));
+
+    // Once shut down, nothing may be written
+    producer.Shutdown();
+    STF_ASSERT_TRUE(consumer.IsShutdown());
+    STF_ASSERT_FALSE(producer.TryWrite({}));
+    STF_ASSERT_FALSE(consumer.Read(record));
+}
+
+STF_TEST(SharedRing, WrapAround)
+{
+    SharedRing producer;
+    SharedRing consumer;
+    std::size_t written = 0;
+    std::size_t read = 0;
+
+    STF_ASSERT_TRUE(producer.Create(4096));
+    STF_ASSERT_TRUE(consumer.Attach(producer.FileDescriptor()));
+
+    // Repeatedly fill the ring and drain it, wrapping around many times
+    for (std::size_t round = 0; round < 200; round++)
+    {
+        while (WriteRecord(producer, written, false)) written++;
+
+        std::span<const std::uint8_t> record;
+        while (consumer.TryRead(record))
+        {
+            STF_ASSERT_TRUE(VerifyRecord(record, read));
+            read++;
+
+            // Release records in batches
+            if (read % 5 == 0) consumer.Release();
+        }
+
+        STF_ASSERT_EQ(written, read);
+        consumer.Release();
+    }
+
+    STF_ASSERT_GT(written, 200 * 4096 / 1500);
+}
+
+STF_TEST(SharedRing, TwoProcesses)
+{
+    constexpr std::size_t Record_Count = 200000;
+    SharedRing ring;
+
+    STF_ASSERT_TRUE(ring.Create(65536));
+
+    pid_t pid = fork();
+    STF_ASSERT_GE(pid, 0);
+
+    if (pid == 0)
+    {
+        // The child process is the producer
+        for (std::size_t i = 0; i < Record_Count; i++)
+        {
+            if (!WriteRecord(ring, i, true)) _exit(1);
+        }
+        ring.Shutdown();
+        _exit(0);
+    }
+
+    // The parent process is the consumer
+    std::span<const std::uint8_t> record;
+    std::size_t count = 0;
+    bool valid = true;
+
+    while (ring.Read(record))
+    {
+        valid = valid && VerifyRecord(record, count);
+        count++;
+        if (count % 16 == 0) ring.Release();
+    }
+
+    int status;
+    STF_ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    STF_ASSERT_TRUE(WIFEXITED(status));
+    STF_ASSERT_EQ(0, WEXITSTATUS(status));
+    STF_ASSERT_TRUE(valid);
+    STF_ASSERT_EQ(Record_Count, count);
+}
+
+STF_TEST(SharedRing, BatchedRelease)
+{
+    constexpr std::size_t Record_Count = 2000;
+    constexpr std::size_t Record_Length = 1500;
+    SharedRing ring;
+
+    // Each batch of unreleased records is larger than the ring
+    STF_ASSERT_TRUE(ring.Create(4096));
+    STF_ASSERT_EQ(4096, ring.Capacity());
+
+    pid_t pid = fork();
+    STF_ASSERT_GE(pid, 0);
+
+    if (pid == 0)
+    {
+        // The child process is the producer
+        std::vector<std::uint8_t> record(Record_Length);
+        for (std::size_t i = 0; i < Record_Count; i++)
+        {
+            for (std::size_t j = 0; j < record.size(); j++)
+            {
+                record[j] = RecordOctet(i, j);
+            }
+            if (!ring.Write(record)) _exit(1);
+        }
+        ring.Shutdown();
+        _exit(0);
+    }
+
+    // The parent process is the consumer, releasing every fourth record
+    std::span<const std::uint8_t> record;
+    std::size_t count = 0;
+    bool valid = true;
+
+    while (ring.Read(record))
+    {
+        valid = valid && (record.size() == Record_Length);
+        for (std::size_t j = 0; valid && (j < record.size()); j++)
+        {
+            valid = (record[j] == RecordOctet(count, j));
+        }
+        count++;
+        if (count % 4 == 0) ring.Release();
+    }
+
+    int status;
+    STF_ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    STF_ASSERT_TRUE(WIFEXITED(status));
+    STF_ASSERT_EQ(0, WEXITSTATUS(status));
+    STF_ASSERT_TRUE(valid);
+    STF_ASSERT_EQ(Record_Count, count);
+}
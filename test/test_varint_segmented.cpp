@@ -0,0 +1,224 @@
+/*
+ *  test_varint_segmented.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the SegmentedReader object, verifying that
+ *      integers are deserialized correctly regardless of how the serialized
+ *      data is divided into segments.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+#include <varint_encoder.h>
+#include <varint_segmented.h>
+#include <stf/stf.h>
+#include "test_values.h"
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// Serialize the given values into a contiguous buffer
+template<typename T>
+std::vector<std::uint8_t> SerializeValues(const std::vector<T> &values)
+{
+    std::vector<std::uint8_t> buffer(values.size() * 10);
+
+    buffer.resize(Serialize(buffer, std::span<const T>(values)));
+
+    return buffer;
+}
+
+// Divide the buffer into segments of the given size, with an empty segment
+// inserted after every third segment
+std::vector<std::span<const std::uint8_t>> Segment(
+    const std::vector<std::uint8_t> &buffer,
+    std::size_t size)
+{
+    std::vector<std::span<const std::uint8_t>> segments;
+    std::span<const std::uint8_t> remaining(buffer);
+
+    while (!remaining.empty())
+    {
+        std::size_t length = std::min(size, remaining.size());
+        segments.push_back(remaining.first(length));
+        remaining = remaining.subspan(length);
+        if (segments.size() % 4 == 3) segments.push_back({});
+    }
+
+    return segments;
+}
+
+// Verify that the values are read from the buffer divided into segments
+template<typename T>
+void VerifySegments(const std::vector<T> &values, std::size_t size)
+{
+    std::vector<std::uint8_t> buffer = SerializeValues(values);
+    std::vector<std::span<const std::uint8_t>> segments =
+        Segment(buffer, size);
+
+    // Deserialize all values at once
+    {
+        SegmentedReader reader(segments);
+        std::vector<T> values2(values.size());
+
+        STF_ASSERT_EQ(buffer.size(), reader.Deserialize(std::span(values2)));
+        STF_ASSERT_EQ(values, values2);
+        STF_ASSERT_EQ(buffer.size(), reader.Position());
+        STF_ASSERT_TRUE(reader.AtEnd());
+
+        // No further values may be read
+        T value;
+        STF_ASSERT_EQ(0, reader.Deserialize(value));
+        STF_ASSERT_EQ(0, reader.Deserialize(std::span(values2).first(1)));
+    }
+
+    // Deserialize values one at a time and in small batches
+    {
+        SegmentedReader reader(segments);
+        std::size_t i = 0;
+
+        while (i < values.size())
+        {
+            if (i % 3)
+            {
+                T value;
+                STF_ASSERT_NE(0, reader.Deserialize(value));
+                STF_ASSERT_EQ(values[i], value);
+                i++;
+            }
+            else
+            {
+                std::vector<T> batch(std::min<std::size_t>(5,
+                                                           values.size() - i));
+                STF_ASSERT_NE(0, reader.Deserialize(std::span(batch)));
+                for (T value : batch) STF_ASSERT_EQ(values[i++], value);
+            }
+        }
+
+        STF_ASSERT_TRUE(reader.AtEnd());
+    }
+}
+
+} // anonymous namespace
+
+STF_TEST(SegmentedReader, UnsignedValues)
+{
+    std::vector<std::uint64_t> values;
+
+    for (std::size_t i = 0; i < 1000; i++) values.push_back(TestValue(i));
+    values[10] = std::numeric_limits<std::uint64_t>::max();
+
+    for (std::size_t size : {1, 2, 3, 7, 10, 11, 64, 1000, 100000})
+    {
+        VerifySegments(values, size);
+    }
+}
+
+STF_TEST(SegmentedReader, SignedValues)
+{
+    std::vector<std::int64_t> values;
+
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        std::int64_t value = static_cast<std::int64_t>(TestValue(i));
+        values.push_back((i % 2) ? value : -value);
+    }
+    values[10] = std::numeric_limits<std::int64_t>::min();
+
+    for (std::size_t size : {1, 2, 3, 7, 10, 11, 64, 1000, 100000})
+    {
+        VerifySegments(values, size);
+    }
+}
+
+STF_TEST(SegmentedReader, SmallBatchesFromLargeSegment)
+{
+    std::vector<std::uint64_t> values;
+
+    // Mostly single-octet values, in one segment and in a few large ones
+    for (std::size_t i = 0; i < 1000000; i++)
+    {
+        values.push_back((i % 97) ? i % 128 : TestValue(i));
+    }
+    std::vector<std::uint8_t> buffer = SerializeValues(values);
+
+    for (std::size_t size : {buffer.size(), std::size_t(1 << 18)})
+    {
+        std::vector<std::span<const std::uint8_t>> segments =
+            Segment(buffer, size);
+
+        // Reading in small batches must not rescan the rest of the segment
+        for (std::size_t batch_size : {1, 16, 63, 64, 65})
+        {
+            SegmentedReader reader(segments);
+            std::vector<std::uint64_t> batch(batch_size);
+            bool valid = true;
+
+            for (std::size_t i = 0; valid && (i < values.size());)
+            {
+                std::size_t count = std::min(batch_size, values.size() - i);
+                std::span<std::uint64_t> wanted =
+                    std::span(batch).first(count);
+
+                valid = (reader.Deserialize(wanted) != 0);
+                for (std::size_t j = 0; valid && (j < count); j++)
+                {
+                    valid = (wanted[j] == values[i++]);
+                }
+            }
+
+            STF_ASSERT_TRUE(valid);
+            STF_ASSERT_TRUE(reader.AtEnd());
+        }
+    }
+}
+
+STF_TEST(SegmentedReader, InvalidData)
+{
+    std::vector<std::uint64_t> values(4);
+    std::uint64_t value;
+
+    // A truncated integer
+    std::vector<std::uint8_t> truncated = {0x01, 0x02, 0x81, 0x82};
+    std::vector<std::span<const std::uint8_t>> segments =
+        Segment(truncated, 3);
+    SegmentedReader reader(segments);
+
+    STF_ASSERT_EQ(0, reader.Deserialize(std::span(values)));
+    STF_ASSERT_EQ(0, reader.Position());
+    STF_ASSERT_EQ(2, reader.Deserialize(std::span(values).first(2)));
+    STF_ASSERT_EQ(0, reader.Deserialize(value));
+    STF_ASSERT_EQ(2, reader.Position());
+    STF_ASSERT_FALSE(reader.AtEnd());
+
+    // An integer longer than 10 octets crossing segments
+    std::vector<std::uint8_t> too_long(12, 0x81);
+    too_long.back() = 0x01;
+    for (std::size_t size : {5, 100})
+    {
+        segments = Segment(too_long, size);
+        reader = SegmentedReader(segments);
+
+        STF_ASSERT_EQ(0, reader.Deserialize(value));
+        STF_ASSERT_EQ(0, reader.Deserialize(std::span(values).first(1)));
+        STF_ASSERT_EQ(0, reader.Position());
+    }
+
+    // No segments at all
+    reader = SegmentedReader();
+    STF_ASSERT_TRUE(reader.AtEnd());
+    STF_ASSERT_EQ(0, reader.Deserialize(value));
+    STF_ASSERT_EQ(0, reader.Deserialize(std::span(values).first(0)));
+}
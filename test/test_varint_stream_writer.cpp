@@ -0,0 +1,249 @@
+/*
+ *  test_varint_stream_writer.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the StreamWriter object, verifying that
+ *      serialized integers written to a file may be deserialized again
+ *      using each of the supported I/O methods.
+ *
+ *  Portability Issues:
+ *      Requires a POSIX system.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#define VARINT_ENCODER_IO_URING 1
+#endif
+#include <varint_encoder.h>
+#include <varint_stream_writer.h>
+#include <stf/stf.h>
+#include "test_values.h"
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// Determine whether the kernel supports io_uring as used by StreamWriter
+bool IoUringSupported()
+{
+#ifdef VARINT_ENCODER_IO_URING
+    io_uring_params params{};
+
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, 1, &params));
+    if (fd < 0) return false;
+    close(fd);
+
+    return (params.features & IORING_FEAT_RW_CUR_POS) != 0;
+#else
+    return false;
+#endif
+}
+
+// Determine whether the file system holding the test files supports O_DIRECT
+bool DirectIOSupported()
+{
+#ifdef O_DIRECT
+    std::string filename = "test_varint_stream_writer_probe_" +
+                           std::to_string(getpid()) + ".bin";
+
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_DIRECT, 0644);
+    if (fd < 0) return false;
+    close(fd);
+    std::remove(filename.c_str());
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Report that a check was skipped for want of support
+void Skipped(const std::string &check)
+{
+    std::cout << "Skipping " << check << " check: not supported here"
+              << std::endl;
+}
+
+// Read the contents of the named file
+std::vector<std::uint8_t> ReadFile(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+}
+
+// Write test values using the given options and verify the file contents,
+// along with the I/O methods used
+void WriteAndVerify(const StreamWriterOptions &options,
+                    std::size_t count,
+                    bool expect_io_uring,
+                    bool expect_direct_io)
+{
+    std::string filename = "test_varint_stream_writer_" +
+                           std::to_string(getpid()) + ".bin";
+    StreamWriter writer;
+
+    STF_ASSERT_TRUE(writer.Open(filename, options));
+    STF_ASSERT_EQ(expect_io_uring, writer.UsingIoUring());
+    STF_ASSERT_EQ(expect_direct_io, writer.UsingDirectIO());
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (i % 2)
+        {
+            STF_ASSERT_TRUE(writer.Write(TestValue(i)));
+        }
+        else
+        {
+            STF_ASSERT_TRUE(
+                writer.Write(static_cast<std::int64_t>(TestValue(i))));
+        }
+
+        // Exercise flushing in the middle of a buffer
+        if (i == count / 3) STF_ASSERT_TRUE(writer.Flush());
+    }
+
+    std::uint64_t bytes_written = writer.BytesWritten();
+    STF_ASSERT_TRUE(writer.Close());
+
+    std::vector<std::uint8_t> data = ReadFile(filename);
+    std::remove(filename.c_str());
+
+    STF_ASSERT_EQ(bytes_written, data.size());
+
+    std::span<std::uint8_t> buffer(data);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::size_t length;
+
+        if (i % 2)
+        {
+            std::uint64_t value;
+            length = Deserialize(buffer, value);
+            STF_ASSERT_EQ(TestValue(i), value);
+        }
+        else
+        {
+            std::int64_t value;
+            length = Deserialize(buffer, value);
+            STF_ASSERT_EQ(static_cast<std::int64_t>(TestValue(i)), value);
+        }
+
+        STF_ASSERT_NE(0, length);
+        buffer = buffer.subspan(length);
+    }
+
+    STF_ASSERT_TRUE(buffer.empty());
+}
+
+} // anonymous namespace
+
+STF_TEST(StreamWriter, WriteUsingPwrite)
+{
+    StreamWriterOptions options;
+
+    options.buffer_size = 4096;
+    options.use_io_uring = false;
+
+    WriteAndVerify(options, 20000, false, false);
+}
+
+STF_TEST(StreamWriter, WriteUsingIoUring)
+{
+    StreamWriterOptions options;
+    bool io_uring = IoUringSupported();
+
+    if (!io_uring) Skipped("io_uring");
+
+    options.buffer_size = 4096;
+    options.buffer_count = 3;
+
+    WriteAndVerify(options, 20000, io_uring, false);
+}
+
+STF_TEST(StreamWriter, WriteUsingDirectIO)
+{
+    StreamWriterOptions options;
+    bool io_uring = IoUringSupported();
+    bool direct_io = DirectIOSupported();
+
+    if (!direct_io) Skipped("O_DIRECT");
+
+    options.buffer_size = 8192;
+    options.direct_io = true;
+
+    WriteAndVerify(options, 20000, io_uring, direct_io);
+
+    options.use_io_uring = false;
+
+    WriteAndVerify(options, 20000, false, direct_io);
+}
+
+STF_TEST(StreamWriter, WriteRawOctets)
+{
+    std::string filename = "test_varint_stream_writer_raw_" +
+                           std::to_string(getpid()) + ".bin";
+    std::vector<std::uint8_t> octets(10000);
+    StreamWriterOptions options;
+    StreamWriter writer;
+
+    for (std::size_t i = 0; i < octets.size(); i++) octets[i] = i & 0xff;
+
+    options.buffer_size = 4096;
+
+    STF_ASSERT_FALSE(writer.IsOpen());
+    STF_ASSERT_TRUE(writer.Open(filename, options));
+    STF_ASSERT_TRUE(writer.IsOpen());
+    STF_ASSERT_TRUE(writer.Write(std::span<const std::uint8_t>(octets)));
+    STF_ASSERT_TRUE(writer.Close());
+    STF_ASSERT_FALSE(writer.IsOpen());
+
+    STF_ASSERT_EQ(octets, ReadFile(filename));
+    std::remove(filename.c_str());
+}
+
+STF_TEST(StreamWriter, WriteAfterClose)
+{
+    std::string filename = "test_varint_stream_writer_closed_" +
+                           std::to_string(getpid()) + ".bin";
+    std::uint8_t octets[] = {0x01, 0x02};
+    StreamWriter writer;
+
+    // Writing before the file is opened fails
+    STF_ASSERT_FALSE(writer.Write(std::uint64_t(1)));
+    STF_ASSERT_FALSE(writer.Write(std::int64_t(-1)));
+    STF_ASSERT_FALSE(writer.Write(std::span<const std::uint8_t>(octets)));
+
+    STF_ASSERT_TRUE(writer.Open(filename));
+    STF_ASSERT_TRUE(writer.Write(std::uint64_t(300)));
+    STF_ASSERT_TRUE(writer.Close());
+    STF_ASSERT_EQ(2, writer.BytesWritten());
+
+    // Writing after the file is closed fails and writes nothing
+    STF_ASSERT_FALSE(writer.Write(std::uint64_t(1)));
+    STF_ASSERT_FALSE(writer.Write(std::int64_t(-1)));
+    STF_ASSERT_FALSE(writer.Write(std::span<const std::uint8_t>(octets)));
+    STF_ASSERT_FALSE(writer.Flush());
+    STF_ASSERT_FALSE(writer.Close());
+    STF_ASSERT_EQ(2, writer.BytesWritten());
+    STF_ASSERT_EQ(2, ReadFile(filename).size());
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,118 @@
+# Test the varint_tool command-line tool
+#
+# Usage: cmake -DTOOL=<path to varint_tool> -P test_varint_tool.cmake
+
+# Run the tool with the given arguments, failing unless the exit status
+# matches the expected status
+function(run_tool expected_status)
+    execute_process(COMMAND ${TOOL} ${ARGN}
+                    RESULT_VARIABLE status
+                    OUTPUT_VARIABLE output
+                    ERROR_VARIABLE error)
+    if(NOT status EQUAL expected_status)
+        message(FATAL_ERROR "varint_tool ${ARGN} returned ${status}: ${error}")
+    endif()
+    set(tool_output "${output}" PARENT_SCOPE)
+endfunction()
+
+# Fail unless the two files are identical
+function(compare_files file1 file2)
+    file(SHA256 ${file1} hash1)
+    file(SHA256 ${file2} hash2)
+    if(NOT hash1 STREQUAL hash2)
+        message(FATAL_ERROR "${file1} and ${file2} differ")
+    endif()
+endfunction()
+
+# Run the tool twice, piping the output of the first run into the second
+# (so the first writes to a pipe and the second reads from one), writing
+# the output of the second run to the given file
+function(run_pipeline output_file)
+    cmake_parse_arguments(PIPE "" "" "FIRST;SECOND" ${ARGN})
+    execute_process(COMMAND ${TOOL} ${PIPE_FIRST}
+                    COMMAND ${TOOL} ${PIPE_SECOND}
+                    OUTPUT_FILE ${output_file}
+                    RESULTS_VARIABLE statuses
+                    ERROR_VARIABLE error)
+    if(NOT statuses STREQUAL "0;0")
+        message(FATAL_ERROR "varint_tool pipeline returned ${statuses}: "
+                            "${error}")
+    endif()
+endfunction()
+
+# Produce text having values of every serialized length
+set(unsigned_text "0\n1\n127\n128\n16383\n16384\n")
+set(signed_text "0\n-1\n63\n-64\n64\n-65\n")
+set(value 1)
+foreach(i RANGE 1 62)
+    math(EXPR value "${value} * 2")
+    math(EXPR negative "0 - ${value}")
+    string(APPEND unsigned_text "${value}\n")
+    string(APPEND signed_text "${value}\n${negative}\n")
+endforeach()
+string(APPEND unsigned_text "18446744073709551615\n")
+string(APPEND signed_text "9223372036854775807\n-9223372036854775808\n")
+
+file(WRITE unsigned.txt "${unsigned_text}")
+file(WRITE signed.txt "${signed_text}")
+
+# Unsigned text round trip
+run_tool(0 encode unsigned.txt unsigned.bin)
+run_tool(0 decode unsigned.bin unsigned_decoded.txt)
+compare_files(unsigned.txt unsigned_decoded.txt)
+
+# Signed text round trip
+run_tool(0 encode --signed signed.txt signed.bin)
+run_tool(0 decode --signed signed.bin signed_decoded.txt)
+compare_files(signed.txt signed_decoded.txt)
+
+# Raw round trip
+run_tool(0 decode --raw unsigned.bin unsigned.raw)
+run_tool(0 encode --raw unsigned.raw unsigned_raw.bin)
+compare_files(unsigned.bin unsigned_raw.bin)
+
+# Pipe enough data through the tool to fill the pipe several times over,
+# exercising vmsplice() output and non-mapped input
+string(REPEAT "${unsigned_text}" 2000 large_unsigned_text)
+file(WRITE large_unsigned.txt "${large_unsigned_text}")
+run_tool(0 encode large_unsigned.txt large_unsigned.bin)
+run_pipeline(pipe_unsigned.bin
+             FIRST decode large_unsigned.bin -
+             SECOND encode - -)
+compare_files(large_unsigned.bin pipe_unsigned.bin)
+run_pipeline(pipe_unsigned.txt
+             FIRST encode large_unsigned.txt
+             SECOND decode)
+compare_files(large_unsigned.txt pipe_unsigned.txt)
+
+# The same, writing to the pipe using write()
+run_pipeline(pipe_no_splice.txt
+             FIRST encode --no-splice large_unsigned.txt -
+             SECOND decode - -)
+compare_files(large_unsigned.txt pipe_no_splice.txt)
+run_pipeline(pipe_no_splice.bin
+             FIRST decode --raw -n large_unsigned.bin
+             SECOND encode --raw)
+compare_files(large_unsigned.bin pipe_no_splice.bin)
+
+# Count, validate, and stats
+run_tool(0 count unsigned.bin)
+if(NOT tool_output STREQUAL "69\n")
+    message(FATAL_ERROR "unexpected count: ${tool_output}")
+endif()
+run_tool(0 validate --signed signed.bin)
+run_tool(0 stats unsigned.bin)
+if(NOT tool_output MATCHES "10 octets: 1 ")
+    message(FATAL_ERROR "unexpected stats: ${tool_output}")
+endif()
+
+# Invalid input must be rejected
+file(WRITE invalid.txt "1\nnot a number\n")
+run_tool(1 encode invalid.txt invalid.bin)
+file(WRITE large.txt "300\n")
+run_tool(0 encode large.txt large.bin)
+file(READ large.bin truncated LIMIT 1)
+file(WRITE truncated.bin "${truncated}")
+run_tool(1 validate truncated.bin)
+run_tool(1 count truncated.bin)
+run_tool(2 unknown)
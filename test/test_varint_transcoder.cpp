@@ -0,0 +1,395 @@
+/*
+ *  test_varint_transcoder.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This test module will test the functions that convert buffers of
+ *      serialized integers to and from other integer encodings.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <varint_encoder.h>
+#include <varint_transcoder.h>
+#include <stf/stf.h>
+#include "test_values.h"
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// Produce a sequence of values having a mix of serialized lengths, with
+// runs of small values so that the vectorized paths are exercised
+std::uint64_t RunTestValue(std::size_t i)
+{
+    if ((i / 32) % 2) return i % 100;
+
+    return TestValue(i);
+}
+
+} // anonymous namespace
+
+STF_TEST(Transcoder, UnsignedLEB128)
+{
+    std::vector<std::uint8_t> encoded;
+    std::vector<std::uint8_t> expected;
+    std::uint8_t octets[10];
+
+    // Serialize the same values using both encodings
+    for (std::size_t i = 0; i < 5000; i++)
+    {
+        std::size_t length = Serialize(octets, RunTestValue(i));
+        encoded.insert(encoded.end(), octets, octets + length);
+
+        length = SerializeLEB128(octets, RunTestValue(i));
+        expected.insert(expected.end(), octets, octets + length);
+    }
+
+    std::vector<std::uint8_t> transcoded(encoded.size());
+    STF_ASSERT_EQ(encoded.size(), TranscodeToLEB128(encoded, transcoded));
+    STF_ASSERT_EQ(expected, transcoded);
+
+    std::vector<std::uint8_t> restored(encoded.size());
+    STF_ASSERT_EQ(encoded.size(), TranscodeFromLEB128(transcoded, restored));
+    STF_ASSERT_EQ(encoded, restored);
+
+    // Transcode in place
+    STF_ASSERT_EQ(encoded.size(), TranscodeToLEB128(restored, restored));
+    STF_ASSERT_EQ(expected, restored);
+}
+
+STF_TEST(Transcoder, SignedLEB128)
+{
+    std::vector<std::uint8_t> encoded;
+    std::vector<std::uint8_t> expected;
+    std::uint8_t octets[10];
+
+    // Serialize the same values using both encodings
+    for (std::size_t i = 0; i < 5000; i++)
+    {
+        std::int64_t value = static_cast<std::int64_t>(RunTestValue(i));
+        if (i % 3) value = -value;
+
+        std::size_t length = Serialize(octets, value);
+        encoded.insert(encoded.end(), octets, octets + length);
+
+        length = SerializeLEB128(octets, value);
+        expected.insert(expected.end(), octets, octets + length);
+    }
+
+    std::int64_t value = std::numeric_limits<std::int64_t>::min();
+    std::size_t length = Serialize(octets, value);
+    encoded.insert(encoded.end(), octets, octets + length);
+    length = SerializeLEB128(octets, value);
+    expected.insert(expected.end(), octets, octets + length);
+
+    std::vector<std::uint8_t> transcoded(encoded.size());
+    STF_ASSERT_EQ(encoded.size(), TranscodeToLEB128(encoded, transcoded));
+    STF_ASSERT_EQ(expected, transcoded);
+
+    std::vector<std::uint8_t> restored(encoded.size());
+    STF_ASSERT_EQ(encoded.size(), TranscodeFromLEB128(transcoded, restored));
+    STF_ASSERT_EQ(encoded, restored);
+}
+
+STF_TEST(Transcoder, InvalidLEB128)
+{
+    std::vector<std::uint8_t> output(64);
+
+    // Incomplete final integer
+    std::vector<std::uint8_t> incomplete(20, 0x01);
+    incomplete.push_back(0x81);
+    STF_ASSERT_EQ(0, TranscodeToLEB128(incomplete, output));
+
+    // Integer longer than 10 octets
+    std::vector<std::uint8_t> too_long(11, 0x81);
+    too_long.push_back(0x00);
+    too_long.resize(32, 0x00);
+    STF_ASSERT_EQ(0, TranscodeFromLEB128(too_long, output));
+
+    // Output buffer too small
+    std::vector<std::uint8_t> input(65, 0x01);
+    STF_ASSERT_EQ(0, TranscodeToLEB128(input, output));
+}
+
+STF_TEST(Transcoder, TenOctetLEB128)
+{
+    std::vector<std::uint8_t> output(64);
+    std::uint64_t value;
+    std::int64_t signed_value;
+
+    // A 10-octet integer may only lead with 0x80, 0x81, or 0xff, whether
+    // alone or following other integers
+    std::vector<std::uint8_t> invalid = {0x85, 0x80, 0x80, 0x80, 0x80,
+                                         0x80, 0x80, 0x80, 0x80, 0x00};
+    STF_ASSERT_EQ(0, Deserialize(invalid, value));
+    STF_ASSERT_EQ(0, TranscodeToLEB128(invalid, output));
+    invalid.insert(invalid.begin(), 20, 0x01);
+    STF_ASSERT_EQ(0, TranscodeToLEB128(invalid, output));
+
+    for (std::uint8_t lead : {0x80, 0x81, 0xff})
+    {
+        std::vector<std::uint8_t> valid = {lead, 0x80, 0x80, 0x80, 0x80,
+                                           0x80, 0x80, 0x80, 0x80, 0x00};
+        STF_ASSERT_EQ(10, TranscodeToLEB128(valid, output));
+    }
+
+    // Likewise, a 10-octet LEB128 integer may only end with 0x00, 0x01,
+    // or 0x7f
+    std::vector<std::uint8_t> invalid_leb128 = {0x80, 0x80, 0x80, 0x80, 0x80,
+                                                0x80, 0x80, 0x80, 0x80, 0x02};
+    STF_ASSERT_EQ(0, DeserializeLEB128(invalid_leb128, value));
+    STF_ASSERT_EQ(0, DeserializeLEB128(invalid_leb128, signed_value));
+    STF_ASSERT_EQ(0, TranscodeFromLEB128(invalid_leb128, output));
+    invalid_leb128.insert(invalid_leb128.begin(), 20, 0x01);
+    STF_ASSERT_EQ(0, TranscodeFromLEB128(invalid_leb128, output));
+
+    // The largest unsigned and smallest signed values are accepted
+    std::vector<std::uint8_t> max_leb128 = {0xff, 0xff, 0xff, 0xff, 0xff,
+                                            0xff, 0xff, 0xff, 0xff, 0x01};
+    STF_ASSERT_EQ(10, TranscodeFromLEB128(max_leb128, output));
+    STF_ASSERT_EQ(10, Deserialize(std::span(output).first(10), value));
+    STF_ASSERT_EQ(std::numeric_limits<std::uint64_t>::max(), value);
+
+    std::vector<std::uint8_t> min_leb128 = {0x80, 0x80, 0x80, 0x80, 0x80,
+                                            0x80, 0x80, 0x80, 0x80, 0x7f};
+    STF_ASSERT_EQ(10, TranscodeFromLEB128(min_leb128, output));
+    STF_ASSERT_EQ(10, Deserialize(std::span(output).first(10), signed_value));
+    STF_ASSERT_EQ(std::numeric_limits<std::int64_t>::min(), signed_value);
+}
+
+STF_TEST(Transcoder, QUIC)
+{
+    std::vector<std::uint8_t> encoded;
+    std::uint8_t octets[10];
+    std::size_t consumed;
+
+    // Serialize values at each of the QUIC length boundaries
+    std::vector<std::uint64_t> values = {0,
+                                         63,
+                                         64,
+                                         16383,
+                                         16384,
+                                         1073741823,
+                                         1073741824,
+                                         4611686018427387903};
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        values.push_back(RunTestValue(i) >> 2);
+    }
+    for (auto value : values)
+    {
+        std::size_t length = Serialize(octets, value);
+        encoded.insert(encoded.end(), octets, octets + length);
+    }
+
+    // Determine the exact size of the output
+    std::size_t size = TranscodeToQUICSize(encoded, consumed);
+    STF_ASSERT_EQ(encoded.size(), consumed);
+    STF_ASSERT_NE(0, size);
+
+    std::vector<std::uint8_t> quic(size);
+    STF_ASSERT_EQ(size, TranscodeToQUIC(encoded, quic, consumed));
+    STF_ASSERT_EQ(encoded.size(), consumed);
+
+    // Check the examples given in RFC 9000, Appendix A.1
+    STF_ASSERT_EQ(0x00, quic[0]);
+    STF_ASSERT_EQ(0x3f, quic[1]);
+    STF_ASSERT_EQ(0x40, quic[2]);
+    STF_ASSERT_EQ(0x40, quic[3]);
+    STF_ASSERT_EQ(0x7f, quic[4]);
+    STF_ASSERT_EQ(0xff, quic[5]);
+    STF_ASSERT_EQ(0x80, quic[6]);
+    STF_ASSERT_EQ(0x00, quic[7]);
+    STF_ASSERT_EQ(0x40, quic[8]);
+    STF_ASSERT_EQ(0x00, quic[9]);
+
+    // Transcode back to the original encoding
+    size = TranscodeFromQUICSize(quic, consumed);
+    STF_ASSERT_EQ(quic.size(), consumed);
+    STF_ASSERT_EQ(encoded.size(), size);
+
+    std::vector<std::uint8_t> restored(size);
+    STF_ASSERT_EQ(size, TranscodeFromQUIC(quic, restored, consumed));
+    STF_ASSERT_EQ(encoded, restored);
+
+    // A non-minimal QUIC encoding (RFC 9000, Appendix A.1) is accepted
+    std::vector<std::uint8_t> two_octet_37 = {0x40, 0x25};
+    STF_ASSERT_EQ(1, TranscodeFromQUIC(two_octet_37, restored, consumed));
+    STF_ASSERT_EQ(37, restored[0]);
+}
+
+STF_TEST(Transcoder, QUICOutOfRange)
+{
+    std::vector<std::uint8_t> encoded;
+    std::vector<std::uint8_t> output(64);
+    std::uint8_t octets[10];
+    std::size_t consumed;
+
+    std::size_t length = Serialize(octets, std::uint64_t(1000));
+    encoded.insert(encoded.end(), octets, octets + length);
+    length = Serialize(octets, std::uint64_t(1) << 62);
+    encoded.insert(encoded.end(), octets, octets + length);
+
+    // The second value is too large and its offset is reported
+    STF_ASSERT_EQ(0, TranscodeToQUICSize(encoded, consumed));
+    STF_ASSERT_EQ(2, consumed);
+    STF_ASSERT_EQ(0, TranscodeToQUIC(encoded, output, consumed));
+    STF_ASSERT_EQ(2, consumed);
+
+    // Output buffer too small
+    encoded.resize(2);
+    STF_ASSERT_EQ(0, TranscodeToQUIC(encoded, std::span(output).first(1),
+                                     consumed));
+    STF_ASSERT_EQ(0, consumed);
+
+    // Incomplete QUIC integer
+    std::vector<std::uint8_t> quic = {0x05, 0xc0, 0x00};
+    STF_ASSERT_EQ(0, TranscodeFromQUIC(quic, output, consumed));
+    STF_ASSERT_EQ(1, consumed);
+}
+
+STF_TEST(Transcoder, UnsignedCBOR)
+{
+    std::vector<std::uint8_t> encoded;
+    std::uint8_t octets[10];
+    std::size_t consumed;
+
+    constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::uint64_t> values = {0,
+                                         23,
+                                         24,
+                                         255,
+                                         256,
+                                         65535,
+                                         65536,
+                                         4294967295,
+                                         4294967296,
+                                         max};
+    for (auto value : values)
+    {
+        std::size_t length = Serialize(octets, value);
+        encoded.insert(encoded.end(), octets, octets + length);
+    }
+
+    std::size_t size = TranscodeToCBORSize(encoded, consumed);
+    STF_ASSERT_EQ(1 + 1 + 2 + 2 + 3 + 3 + 5 + 5 + 9 + 9, size);
+
+    std::vector<std::uint8_t> cbor(size);
+    STF_ASSERT_EQ(size, TranscodeToCBOR(encoded, cbor, consumed));
+    STF_ASSERT_EQ(encoded.size(), consumed);
+
+    // Check the examples given in RFC 8949, Appendix A
+    STF_ASSERT_EQ(0x00, cbor[0]);
+    STF_ASSERT_EQ(0x17, cbor[1]);
+    STF_ASSERT_EQ(0x18, cbor[2]);
+    STF_ASSERT_EQ(0x18, cbor[3]);
+    STF_ASSERT_EQ(0x18, cbor[4]);
+    STF_ASSERT_EQ(0xff, cbor[5]);
+    STF_ASSERT_EQ(0x19, cbor[6]);
+    STF_ASSERT_EQ(0x01, cbor[7]);
+    STF_ASSERT_EQ(0x00, cbor[8]);
+    STF_ASSERT_EQ(0x1b, cbor[size - 9]);
+    STF_ASSERT_EQ(0xff, cbor[size - 1]);
+
+    size = TranscodeFromCBORSize(cbor, consumed);
+    STF_ASSERT_EQ(encoded.size(), size);
+
+    std::vector<std::uint8_t> restored(size);
+    STF_ASSERT_EQ(size, TranscodeFromCBOR(cbor, restored, consumed));
+    STF_ASSERT_EQ(encoded, restored);
+
+    // Negative integers cannot be represented as unsigned integers
+    std::vector<std::uint8_t> negative = {0x01, 0x20};
+    STF_ASSERT_EQ(0, TranscodeFromCBORSize(negative, consumed));
+    STF_ASSERT_EQ(1, consumed);
+
+    // Other data items (here, a text string) are rejected
+    std::vector<std::uint8_t> text = {0x61, 0x61};
+    STF_ASSERT_EQ(0, TranscodeFromCBOR(text, restored, consumed));
+    STF_ASSERT_EQ(0, consumed);
+}
+
+STF_TEST(Transcoder, SignedCBOR)
+{
+    std::vector<std::uint8_t> encoded;
+    std::uint8_t octets[10];
+    std::size_t consumed;
+
+    constexpr auto min = std::numeric_limits<std::int64_t>::min();
+    constexpr auto max = std::numeric_limits<std::int64_t>::max();
+    std::vector<std::int64_t> values = {0,
+                                        -1,
+                                        -24,
+                                        -25,
+                                        -100,
+                                        -1000,
+                                        1000000,
+                                        min,
+                                        max};
+    for (auto value : values)
+    {
+        std::size_t length = Serialize(octets, value);
+        encoded.insert(encoded.end(), octets, octets + length);
+    }
+
+    std::size_t size = TranscodeSignedToCBORSize(encoded, consumed);
+    std::vector<std::uint8_t> cbor(size);
+    STF_ASSERT_EQ(size, TranscodeSignedToCBOR(encoded, cbor, consumed));
+    STF_ASSERT_EQ(encoded.size(), consumed);
+
+    // Check the examples given in RFC 8949, Appendix A
+    std::vector<std::uint8_t> expected = {0x00,
+                                          0x20,
+                                          0x37,
+                                          0x38, 0x18,
+                                          0x38, 0x63,
+                                          0x39, 0x03, 0xe7,
+                                          0x1a, 0x00, 0x0f, 0x42, 0x40};
+    STF_ASSERT_TRUE(
+        std::equal(expected.begin(), expected.end(), cbor.begin()));
+
+    size = TranscodeSignedFromCBORSize(cbor, consumed);
+    STF_ASSERT_EQ(encoded.size(), size);
+
+    std::vector<std::uint8_t> restored(size);
+    STF_ASSERT_EQ(size, TranscodeSignedFromCBOR(cbor, restored, consumed));
+    STF_ASSERT_EQ(encoded, restored);
+
+    // -2^64 cannot be represented as a std::int64_t
+    std::vector<std::uint8_t> too_small =
+        {0x20, 0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    STF_ASSERT_EQ(0, TranscodeSignedFromCBOR(too_small, restored, consumed));
+    STF_ASSERT_EQ(1, consumed);
+}
+
+STF_TEST(Transcoder, PaddedIntegers)
+{
+    std::uint8_t encoded[13];
+    std::uint8_t cbor[16];
+    std::size_t consumed;
+
+    // Integers padded to 10 and 3 octets
+    STF_ASSERT_EQ(10, Serialize(encoded, std::uint64_t(1), 10));
+    STF_ASSERT_EQ(3, Serialize(std::span(encoded).subspan(10),
+                               std::uint64_t(24),
+                               3));
+
+    // CBOR has no padding, so each value is written in its shortest form
+    STF_ASSERT_EQ(3, TranscodeToCBORSize(encoded, consumed));
+    STF_ASSERT_EQ(3, TranscodeToCBOR(encoded, cbor, consumed));
+    STF_ASSERT_EQ(13, consumed);
+    STF_ASSERT_EQ(0x01, cbor[0]);
+    STF_ASSERT_EQ(0x18, cbor[1]);
+    STF_ASSERT_EQ(0x18, cbor[2]);
+}
@@ -0,0 +1,1375 @@
+/*
+ *  varint_tool.cpp
+ *
+ *  Copyright (C) 2023
+ *  Paul E. Jones <paulej@packetizer.com>
+ *  All Rights Reserved
+ *
+ *  Description:
+ *      This is a command-line tool that converts between streams of
+ *      serialized variable-length integers and either newline-separated
+ *      decimal text or raw little-endian 64-bit integers.  It can also
+ *      count, validate, and report statistics about a stream of serialized
+ *      integers.
+ *
+ *      Usage:
+ *          varint_tool <command> [options] [input [output]]
+ *
+ *      Commands:
+ *          encode      Serialize text (or raw) integers
+ *          decode      Deserialize integers to text (or raw)
+ *          count       Count serialized integers without validating them
+ *          validate    Verify every serialized integer is valid
+ *          stats       Report serialized length and value statistics
+ *
+ *      Options:
+ *          -s, --signed        Integers are signed
+ *          -r, --raw           Use raw little-endian 64-bit integers
+ *                              rather than text
+ *          -n, --no-splice     Do not use vmsplice() to write to a pipe
+ *
+ *      An input or output of "-" (or one not given) refers to standard
+ *      input or standard output.
+ *
+ *      Regular input files are memory-mapped.  When the output is a pipe,
+ *      output buffers are handed to the pipe using vmsplice() rather than
+ *      being copied with write().  To ensure a buffer is not modified while
+ *      the pipe still refers to it, output cycles through a ring of buffers
+ *      whose total size exceeds the pipe capacity.  This relies on the
+ *      reader consuming data from the pipe; if the reader instead moves the
+ *      data to another pipe using splice() (as some pipeline utilities do),
+ *      the --no-splice option must be given.
+ *
+ *  Portability Issues:
+ *      Requires a POSIX system.  The use of vmsplice() is specific to Linux.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/uio.h>
+#endif
+#include <varint_encoder.h>
+
+using namespace VarIntEncoder;
+
+namespace
+{
+
+// Largest number of octets in a serialized 64-bit integer
+constexpr std::size_t Max_Octets = 10;
+
+// Largest number of octets in a decimal 64-bit integer, plus newline
+constexpr std::size_t Max_Text_Octets = 21;
+
+// Number of integers (or octets of serialized integers) per batch
+constexpr std::size_t Batch_Size = 65536;
+
+// Size of the buffer used to read non-regular input files
+constexpr std::size_t Input_Buffer_Size = 4 << 20;
+
+// Size of each output buffer, which must exceed the largest reservation
+constexpr std::size_t Output_Buffer_Size = 4 << 20;
+
+// Largest output reservation made by any command
+constexpr std::size_t Max_Reserve = Batch_Size * Max_Text_Octets;
+
+// Pipe capacity requested when writing to a pipe
+constexpr int Requested_Pipe_Size = 1 << 20;
+
+static_assert(Max_Reserve < Output_Buffer_Size / 2);
+
+// Options given on the command line
+struct Options
+{
+    bool is_signed{false};
+    bool raw{false};
+    bool splice{true};
+};
+
+/*
+ *  Input
+ *
+ *  Description:
+ *      This object provides the contents of an input file.  A regular file
+ *      is memory-mapped in its entirety, while any other file (e.g., a
+ *      pipe) is read into a buffer as the data is consumed.
+ */
+class Input
+{
+    public:
+        Input() = default;
+        Input(const Input &) = delete;
+        Input &operator=(const Input &) = delete;
+        ~Input();
+
+        bool Open(const std::string &path);
+        bool Fill();
+        void Consume(std::size_t length) { position += length; }
+
+        std::span<const std::uint8_t> Data() const
+        {
+            return {data + position, size - position};
+        }
+
+        bool Eof() const { return eof; }
+
+    protected:
+        int fd{-1};
+        bool mapped{false};
+        bool eof{false};
+        const std::uint8_t *data{nullptr};
+        std::size_t size{0};
+        std::size_t position{0};
+        std::vector<std::uint8_t> buffer;
+};
+
+/*
+ *  Output
+ *
+ *  Description:
+ *      This object accumulates data to be written to an output file.  Space
+ *      is reserved in the current output buffer, filled, and then committed.
+ *      When the output file is a pipe, full buffers are spliced into the
+ *      pipe using vmsplice() rather than copied.
+ */
+class Output
+{
+    public:
+        Output() = default;
+        Output(const Output &) = delete;
+        Output &operator=(const Output &) = delete;
+        ~Output();
+
+        bool Open(const std::string &path, bool splice);
+        std::uint8_t *Reserve(std::size_t length);
+        void Commit(std::size_t length) { used += length; }
+        bool Close();
+
+    protected:
+        bool WriteBuffer();
+        bool WriteOctets(const std::uint8_t *octets, std::size_t length);
+        bool SpliceOctets(const std::uint8_t *octets, std::size_t length);
+
+        int fd{-1};
+        bool close_fd{false};
+        bool splice{false};
+        std::vector<std::uint8_t *> buffers;
+        std::size_t current{0};
+        std::size_t used{0};
+};
+
+/*
+ *  Input::~Input()
+ *
+ *  Description:
+ *      Destructor for the Input object, which will unmap and close the file.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+Input::~Input()
+{
+    if (mapped) munmap(const_cast<std::uint8_t *>(data), size);
+    if (fd > STDIN_FILENO) close(fd);
+}
+
+/*
+ *  Input::Open()
+ *
+ *  Description:
+ *      This function will open the named input file, mapping it into memory
+ *      if it is a regular file.
+ *
+ *  Parameters:
+ *      path [in]
+ *          The path of the file to open, or "-" for standard input.
+ *
+ *  Returns:
+ *      True if the file was opened, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool Input::Open(const std::string &path)
+{
+    struct stat file_stat;
+
+    if (path == "-")
+    {
+        fd = STDIN_FILENO;
+    }
+    else if ((fd = open(path.c_str(), O_RDONLY)) < 0)
+    {
+        std::fprintf(stderr, "unable to open %s: %s\n", path.c_str(),
+                     std::strerror(errno));
+        return false;
+    }
+
+    // Map regular files into memory in their entirety
+    if ((fstat(fd, &file_stat) == 0) && S_ISREG(file_stat.st_mode))
+    {
+        size = static_cast<std::size_t>(file_stat.st_size);
+        eof = true;
+
+        if (size == 0) return true;
+
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            madvise(map, size, MADV_SEQUENTIAL);
+            data = static_cast<const std::uint8_t *>(map);
+            mapped = true;
+            return true;
+        }
+
+        // Fall back to reading the file
+        size = 0;
+        eof = false;
+    }
+
+    buffer.resize(Input_Buffer_Size);
+    data = buffer.data();
+
+    return true;
+}
+
+/*
+ *  Input::Fill()
+ *
+ *  Description:
+ *      This function will read more data from the input file, retaining
+ *      the data not yet consumed.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if successful, including reaching the end of the file, or
+ *      false if there was an error.
+ *
+ *  Comments:
+ *      The input buffer is filled before returning, unless the end of the
+ *      file is reached, so that large batches are processed.
+ */
+bool Input::Fill()
+{
+    if (eof) return true;
+
+    // Move the unconsumed data to the start of the buffer
+    if (position > 0)
+    {
+        std::memmove(buffer.data(), buffer.data() + position, size - position);
+        size -= position;
+        position = 0;
+    }
+
+    if (size == buffer.size())
+    {
+        std::fprintf(stderr, "input line too long\n");
+        return false;
+    }
+
+    while (size < buffer.size())
+    {
+        ssize_t result = read(fd, buffer.data() + size, buffer.size() - size);
+
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            std::fprintf(stderr, "read error: %s\n", std::strerror(errno));
+            return false;
+        }
+
+        if (result == 0)
+        {
+            eof = true;
+            break;
+        }
+
+        size += static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+/*
+ *  Output::~Output()
+ *
+ *  Description:
+ *      Destructor for the Output object, which will release the output
+ *      buffers and close the file.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Any data not yet written is discarded; call Close() to write it.
+ */
+Output::~Output()
+{
+    for (std::uint8_t *buffer : buffers) munmap(buffer, Output_Buffer_Size);
+    if (close_fd) close(fd);
+}
+
+/*
+ *  Output::Open()
+ *
+ *  Description:
+ *      This function will open the named output file and allocate output
+ *      buffers.
+ *
+ *  Parameters:
+ *      path [in]
+ *          The path of the file to open, or "-" for standard output.
+ *
+ *      splice [in]
+ *          Whether vmsplice() may be used if the file is a pipe.
+ *
+ *  Returns:
+ *      True if the file was opened, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool Output::Open(const std::string &path, bool splice)
+{
+    struct stat file_stat;
+    std::size_t buffer_count = 1;
+
+    if (path == "-")
+    {
+        fd = STDOUT_FILENO;
+    }
+    else
+    {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0)
+        {
+            std::fprintf(stderr, "unable to open %s: %s\n", path.c_str(),
+                         std::strerror(errno));
+            return false;
+        }
+        close_fd = true;
+    }
+
+#if defined(__linux__)
+    // Splice into pipes using a ring of buffers exceeding the pipe capacity
+    if (splice && (fstat(fd, &file_stat) == 0) && S_ISFIFO(file_stat.st_mode))
+    {
+        fcntl(fd, F_SETPIPE_SZ, Requested_Pipe_Size);
+
+        int pipe_size = fcntl(fd, F_GETPIPE_SZ);
+        if (pipe_size > 0)
+        {
+            // Every buffer but the last is at least half full when spliced,
+            // so once the other buffers are spliced after a given buffer,
+            // the pipe can no longer refer to it
+            std::size_t page_size = sysconf(_SC_PAGESIZE);
+            std::size_t pipe_pages = pipe_size / page_size;
+            std::size_t buffer_pages = Output_Buffer_Size / 2 / page_size;
+
+            buffer_count = (pipe_pages + buffer_pages - 1) / buffer_pages + 2;
+            this->splice = true;
+        }
+    }
+#else
+    (void) file_stat;
+    (void) splice;
+#endif
+
+    // Allocate page-aligned output buffers
+    for (std::size_t i = 0; i < buffer_count; i++)
+    {
+        void *buffer = mmap(nullptr,
+                            Output_Buffer_Size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1,
+                            0);
+        if (buffer == MAP_FAILED)
+        {
+            std::fprintf(stderr, "unable to allocate memory\n");
+            return false;
+        }
+        buffers.push_back(static_cast<std::uint8_t *>(buffer));
+    }
+
+    return true;
+}
+
+/*
+ *  Output::Reserve()
+ *
+ *  Description:
+ *      This function will reserve space in the current output buffer,
+ *      writing the buffer first if there is insufficient space.
+ *
+ *  Parameters:
+ *      length [in]
+ *          The number of octets to reserve, which may not exceed
+ *          Max_Reserve.
+ *
+ *  Returns:
+ *      A pointer to the reserved space, or nullptr if there was an error.
+ *
+ *  Comments:
+ *      Commit() must be called to indicate the number of octets used.
+ */
+std::uint8_t *Output::Reserve(std::size_t length)
+{
+    if ((Output_Buffer_Size - used < length) && !WriteBuffer()) return nullptr;
+
+    return buffers[current] + used;
+}
+
+/*
+ *  Output::Close()
+ *
+ *  Description:
+ *      This function will write any remaining data and close the file.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool Output::Close()
+{
+    bool result = WriteBuffer();
+
+    if (close_fd && (close(fd) < 0) && result)
+    {
+        std::fprintf(stderr, "write error: %s\n", std::strerror(errno));
+        result = false;
+    }
+    close_fd = false;
+
+    return result;
+}
+
+/*
+ *  Output::WriteBuffer()
+ *
+ *  Description:
+ *      This function will write the current output buffer to the file and
+ *      advance to the next buffer in the ring.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool Output::WriteBuffer()
+{
+    bool result = true;
+
+    if (used == 0) return true;
+
+    if (splice)
+    {
+        result = SpliceOctets(buffers[current], used);
+    }
+    else
+    {
+        result = WriteOctets(buffers[current], used);
+    }
+
+    current = (current + 1) % buffers.size();
+    used = 0;
+
+    return result;
+}
+
+/*
+ *  Output::WriteOctets()
+ *
+ *  Description:
+ *      This function will write the given octets to the file using write().
+ *
+ *  Parameters:
+ *      octets [in]
+ *          The octets to write.
+ *
+ *      length [in]
+ *          The number of octets to write.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool Output::WriteOctets(const std::uint8_t *octets, std::size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t result = write(fd, octets, length);
+
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            std::fprintf(stderr, "write error: %s\n", std::strerror(errno));
+            return false;
+        }
+
+        octets += result;
+        length -= static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+/*
+ *  Output::SpliceOctets()
+ *
+ *  Description:
+ *      This function will hand the given octets to the pipe using
+ *      vmsplice(), falling back to write() if vmsplice() is not supported.
+ *
+ *  Parameters:
+ *      octets [in]
+ *          The octets to write.
+ *
+ *      length [in]
+ *          The number of octets to write.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+bool Output::SpliceOctets(const std::uint8_t *octets, std::size_t length)
+{
+#if defined(__linux__)
+    while (length > 0)
+    {
+        struct iovec iov;
+
+        iov.iov_base = const_cast<std::uint8_t *>(octets);
+        iov.iov_len = length;
+
+        ssize_t result = vmsplice(fd, &iov, 1, 0);
+
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EPIPE)
+            {
+                std::fprintf(stderr, "write error: %s\n",
+                             std::strerror(errno));
+                return false;
+            }
+
+            // Use write() for this and all subsequent data
+            splice = false;
+            break;
+        }
+
+        octets += result;
+        length -= static_cast<std::size_t>(result);
+    }
+#endif
+
+    return WriteOctets(octets, length);
+}
+
+/*
+ *  ToLittleEndian()
+ *
+ *  Description:
+ *      This function will convert between host and little-endian byte order.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to convert.
+ *
+ *  Returns:
+ *      The converted value.
+ *
+ *  Comments:
+ *      The conversion is its own inverse.
+ */
+constexpr std::uint64_t ToLittleEndian(std::uint64_t value)
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        value = __builtin_bswap64(value);
+    }
+
+    return value;
+}
+
+/*
+ *  CountTerminators()
+ *
+ *  Description:
+ *      This function will count the number of octets having a zero MSb,
+ *      which is the number of serialized integers ending in the data.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers.
+ *
+ *  Returns:
+ *      The number of octets having a zero MSb.
+ *
+ *  Comments:
+ *      The loop is written to allow the compiler to vectorize it.
+ */
+std::size_t CountTerminators(std::span<const std::uint8_t> data)
+{
+    std::size_t count = 0;
+
+    for (std::uint8_t octet : data) count += (octet >> 7) ^ 1;
+
+    return count;
+}
+
+/*
+ *  FindInvalid()
+ *
+ *  Description:
+ *      This function will locate the first invalid serialized integer in
+ *      the given data.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The serialized integers.
+ *
+ *  Returns:
+ *      The offset of the first invalid integer.
+ *
+ *  Comments:
+ *      This is called only once data is known to contain an invalid integer.
+ */
+template<typename T>
+std::size_t FindInvalid(std::span<const std::uint8_t> data)
+{
+    std::size_t position = 0;
+    std::size_t length;
+    T value;
+
+    while ((length = Deserialize(data.subspan(position), value)) > 0)
+    {
+        position += length;
+    }
+
+    return position;
+}
+
+/*
+ *  DecodeStream()
+ *
+ *  Description:
+ *      This function will deserialize every integer in the input, passing
+ *      batches of values to the given function.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read serialized integers.
+ *
+ *      consume [in]
+ *          A function called with each batch of values and the serialized
+ *          octets from which they were deserialized, returning false if
+ *          there was an error.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      Each batch is sized by counting the octets that end an integer, so
+ *      that the batch Deserialize() function may be used.
+ */
+template<typename T, typename Function>
+bool DecodeStream(Input &input, Function consume)
+{
+    std::vector<T> values(Batch_Size);
+    std::uint64_t offset = 0;
+
+    while (true)
+    {
+        std::span<const std::uint8_t> data = input.Data();
+        std::span<const std::uint8_t> window =
+            data.first(std::min(data.size(), Batch_Size));
+
+        // Locate the end of the last complete integer in the window
+        std::size_t end = window.size();
+        while ((end > 0) && (window[end - 1] & 0x80)) end--;
+
+        if (end == 0)
+        {
+            if (window.size() >= Max_Octets)
+            {
+                std::fprintf(stderr,
+                             "invalid integer at offset %llu\n",
+                             static_cast<unsigned long long>(offset));
+                return false;
+            }
+
+            if (input.Eof())
+            {
+                if (data.empty()) return true;
+
+                std::fprintf(stderr,
+                             "truncated integer at offset %llu\n",
+                             static_cast<unsigned long long>(offset));
+                return false;
+            }
+
+            if (!input.Fill()) return false;
+
+            continue;
+        }
+
+        window = window.first(end);
+
+        std::span<T> batch(values.data(), CountTerminators(window));
+
+        if (Deserialize(window, batch) != end)
+        {
+            std::fprintf(stderr,
+                         "invalid integer at offset %llu\n",
+                         static_cast<unsigned long long>(
+                             offset + FindInvalid<T>(window)));
+            return false;
+        }
+
+        if (!consume(std::span<const T>(batch), window)) return false;
+
+        input.Consume(end);
+        offset += end;
+    }
+}
+
+/*
+ *  ParseText()
+ *
+ *  Description:
+ *      This function will parse decimal integers, one per line, from the
+ *      given text.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to parse.
+ *
+ *      eof [in]
+ *          Whether the text ends at the end of the input, such that a final
+ *          line need not end with a newline.
+ *
+ *      values [out]
+ *          The values parsed from the text.
+ *
+ *      consumed [out]
+ *          The number of octets of text consumed.
+ *
+ *      line [in/out]
+ *          The current line number, used when reporting errors.
+ *
+ *  Returns:
+ *      The number of values parsed, or -1 if there was an error.
+ *
+ *  Comments:
+ *      Blank lines are ignored, as is whitespace surrounding each integer.
+ */
+template<typename T>
+std::ptrdiff_t ParseText(std::span<const std::uint8_t> text,
+                         bool eof,
+                         std::span<T> values,
+                         std::size_t &consumed,
+                         std::uint64_t &line)
+{
+    const char *begin = reinterpret_cast<const char *>(text.data());
+    const char *end = begin + text.size();
+    const char *p = begin;
+    std::size_t count = 0;
+
+    while ((count < values.size()) && (p < end))
+    {
+        const char *newline =
+            static_cast<const char *>(std::memchr(p, '\n', end - p));
+
+        if ((newline == nullptr) && !eof) break;
+
+        const char *line_end = newline ? newline : end;
+        const char *q = p;
+
+        // Skip surrounding whitespace
+        while ((q < line_end) && ((*q == ' ') || (*q == '\t'))) q++;
+        const char *r = line_end;
+        while ((r > q) && ((r[-1] == ' ') || (r[-1] == '\t') ||
+                           (r[-1] == '\r')))
+        {
+            r--;
+        }
+
+        line++;
+
+        if (q < r)
+        {
+            std::from_chars_result result =
+                std::from_chars(q, r, values[count]);
+
+            if ((result.ec != std::errc()) || (result.ptr != r))
+            {
+                std::fprintf(stderr, "invalid integer on line %llu\n",
+                             static_cast<unsigned long long>(line));
+                return -1;
+            }
+
+            count++;
+        }
+
+        p = newline ? newline + 1 : end;
+    }
+
+    consumed = p - begin;
+
+    return count;
+}
+
+/*
+ *  EncodeText()
+ *
+ *  Description:
+ *      This function will serialize the decimal integers read from the
+ *      input.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read text.
+ *
+ *      output [in]
+ *          The output to which serialized integers are written.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool EncodeText(Input &input, Output &output)
+{
+    std::vector<T> values(Batch_Size);
+    std::uint64_t line = 0;
+
+    while (true)
+    {
+        std::size_t consumed;
+        std::ptrdiff_t count =
+            ParseText(input.Data(), input.Eof(), std::span(values), consumed,
+                      line);
+
+        if (count < 0) return false;
+
+        if (count > 0)
+        {
+            std::size_t length = static_cast<std::size_t>(count) * Max_Octets;
+            std::uint8_t *buffer = output.Reserve(length);
+            if (buffer == nullptr) return false;
+
+            output.Commit(Serialize(
+                std::span(buffer, length),
+                std::span<const T>(values.data(), count)));
+        }
+
+        input.Consume(consumed);
+
+        if (consumed == 0)
+        {
+            if (input.Eof()) return true;
+            if (!input.Fill()) return false;
+        }
+    }
+}
+
+/*
+ *  EncodeRaw()
+ *
+ *  Description:
+ *      This function will serialize the raw little-endian 64-bit integers
+ *      read from the input.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read raw integers.
+ *
+ *      output [in]
+ *          The output to which serialized integers are written.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool EncodeRaw(Input &input, Output &output)
+{
+    std::vector<T> values(Batch_Size);
+
+    while (true)
+    {
+        std::span<const std::uint8_t> data = input.Data();
+        std::size_t count = std::min(data.size() / sizeof(T), Batch_Size);
+
+        if (count == 0)
+        {
+            if (input.Eof())
+            {
+                if (data.empty()) return true;
+
+                std::fprintf(stderr, "input is not a multiple of %zu "
+                                     "octets\n", sizeof(T));
+                return false;
+            }
+
+            if (!input.Fill()) return false;
+
+            continue;
+        }
+
+        std::memcpy(values.data(), data.data(), count * sizeof(T));
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values[i] = static_cast<T>(
+                ToLittleEndian(static_cast<std::uint64_t>(values[i])));
+        }
+
+        std::uint8_t *buffer = output.Reserve(count * Max_Octets);
+        if (buffer == nullptr) return false;
+
+        output.Commit(Serialize(std::span(buffer, count * Max_Octets),
+                                std::span<const T>(values.data(), count)));
+
+        input.Consume(count * sizeof(T));
+    }
+}
+
+/*
+ *  Decode()
+ *
+ *  Description:
+ *      This function will deserialize the integers read from the input,
+ *      writing them as decimal text or raw little-endian 64-bit integers.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read serialized integers.
+ *
+ *      output [in]
+ *          The output to which the integers are written.
+ *
+ *      raw [in]
+ *          Whether to write raw integers rather than text.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool Decode(Input &input, Output &output, bool raw)
+{
+    return DecodeStream<T>(
+        input,
+        [&](std::span<const T> values, std::span<const std::uint8_t>)
+        {
+            if (raw)
+            {
+                std::uint8_t *buffer =
+                    output.Reserve(values.size() * sizeof(T));
+                if (buffer == nullptr) return false;
+
+                for (T value : values)
+                {
+                    std::uint64_t octets =
+                        ToLittleEndian(static_cast<std::uint64_t>(value));
+                    std::memcpy(buffer, &octets, sizeof(octets));
+                    buffer += sizeof(octets);
+                }
+
+                output.Commit(values.size() * sizeof(T));
+
+                return true;
+            }
+
+            char *buffer = reinterpret_cast<char *>(
+                output.Reserve(values.size() * Max_Text_Octets));
+            if (buffer == nullptr) return false;
+
+            char *p = buffer;
+            for (T value : values)
+            {
+                p = std::to_chars(p, p + Max_Text_Octets, value).ptr;
+                *p++ = '\n';
+            }
+
+            output.Commit(p - buffer);
+
+            return true;
+        });
+}
+
+/*
+ *  Count()
+ *
+ *  Description:
+ *      This function will count the serialized integers in the input.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read serialized integers.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      The integers are not validated, so this is as fast as the input
+ *      can be read.
+ */
+bool Count(Input &input)
+{
+    std::uint64_t count = 0;
+    std::uint8_t last_octet = 0;
+
+    while (true)
+    {
+        std::span<const std::uint8_t> data = input.Data();
+
+        count += CountTerminators(data);
+        if (!data.empty()) last_octet = data.back();
+        input.Consume(data.size());
+
+        if (input.Eof()) break;
+        if (!input.Fill()) return false;
+    }
+
+    // The final octet must end an integer
+    if (last_octet & 0x80)
+    {
+        std::fprintf(stderr, "truncated integer at end of input\n");
+        return false;
+    }
+
+    std::printf("%llu\n", static_cast<unsigned long long>(count));
+
+    return true;
+}
+
+/*
+ *  Validate()
+ *
+ *  Description:
+ *      This function will verify that every serialized integer in the input
+ *      is valid.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read serialized integers.
+ *
+ *  Returns:
+ *      True if all integers are valid, false otherwise.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool Validate(Input &input)
+{
+    std::uint64_t count = 0;
+
+    bool result = DecodeStream<T>(
+        input,
+        [&](std::span<const T> values, std::span<const std::uint8_t>)
+        {
+            count += values.size();
+            return true;
+        });
+
+    if (result)
+    {
+        std::printf("valid: %llu integers\n",
+                    static_cast<unsigned long long>(count));
+    }
+
+    return result;
+}
+
+/*
+ *  Stats()
+ *
+ *  Description:
+ *      This function will report the number of serialized integers in the
+ *      input, the distribution of their serialized lengths, and the range
+ *      of their values.
+ *
+ *  Parameters:
+ *      input [in]
+ *          The input from which to read serialized integers.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool Stats(Input &input)
+{
+    std::uint64_t lengths[Max_Octets + 1]{};
+    std::uint64_t count = 0;
+    std::uint64_t octets = 0;
+    T minimum = std::numeric_limits<T>::max();
+    T maximum = std::numeric_limits<T>::min();
+
+    bool result = DecodeStream<T>(
+        input,
+        [&](std::span<const T> values, std::span<const std::uint8_t> data)
+        {
+            // The batch ends with a complete integer
+            std::size_t length = 0;
+            for (std::uint8_t octet : data)
+            {
+                length++;
+                if (!(octet & 0x80))
+                {
+                    lengths[length]++;
+                    length = 0;
+                }
+            }
+
+            for (T value : values)
+            {
+                minimum = std::min(minimum, value);
+                maximum = std::max(maximum, value);
+            }
+
+            count += values.size();
+            octets += data.size();
+
+            return true;
+        });
+
+    if (!result) return false;
+
+    std::printf("integers: %llu\n", static_cast<unsigned long long>(count));
+    std::printf("octets:   %llu\n", static_cast<unsigned long long>(octets));
+
+    if (count == 0) return true;
+
+    std::printf("mean:     %.3f octets\n",
+                static_cast<double>(octets) / static_cast<double>(count));
+    std::printf("minimum:  %s\n", std::to_string(minimum).c_str());
+    std::printf("maximum:  %s\n", std::to_string(maximum).c_str());
+
+    for (std::size_t i = 1; i <= Max_Octets; i++)
+    {
+        if (lengths[i] == 0) continue;
+
+        std::printf("%2zu octets: %llu (%.2f%%)\n",
+                    i,
+                    static_cast<unsigned long long>(lengths[i]),
+                    100.0 * static_cast<double>(lengths[i]) /
+                        static_cast<double>(count));
+    }
+
+    return true;
+}
+
+/*
+ *  Usage()
+ *
+ *  Description:
+ *      This function will print the command usage.
+ *
+ *  Parameters:
+ *      program [in]
+ *          The name of the program.
+ *
+ *  Returns:
+ *      The exit status for a usage error.
+ *
+ *  Comments:
+ *      None.
+ */
+int Usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s <command> [options] [input [output]]\n"
+                 "\n"
+                 "commands:\n"
+                 "  encode     serialize text (or raw) integers\n"
+                 "  decode     deserialize integers to text (or raw)\n"
+                 "  count      count serialized integers\n"
+                 "  validate   verify every serialized integer is valid\n"
+                 "  stats      report length and value statistics\n"
+                 "\n"
+                 "options:\n"
+                 "  -s, --signed      integers are signed\n"
+                 "  -r, --raw         use raw little-endian 64-bit "
+                 "integers rather than text\n"
+                 "  -n, --no-splice   do not use vmsplice() to write to "
+                 "a pipe\n",
+                 program);
+
+    return 2;
+}
+
+/*
+ *  Run()
+ *
+ *  Description:
+ *      This function will run the given command.
+ *
+ *  Parameters:
+ *      command [in]
+ *          The command to run.
+ *
+ *      input [in]
+ *          The input file.
+ *
+ *      output_path [in]
+ *          The path of the output file.
+ *
+ *      options [in]
+ *          The command-line options.
+ *
+ *  Returns:
+ *      True if successful, false if there was an error.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+bool Run(const std::string &command,
+         Input &input,
+         const std::string &output_path,
+         const Options &options)
+{
+    if (command == "validate") return Validate<T>(input);
+    if (command == "stats") return Stats<T>(input);
+
+    Output output;
+
+    if (!output.Open(output_path, options.splice)) return false;
+
+    bool result;
+
+    if (command == "encode")
+    {
+        result = options.raw ? EncodeRaw<T>(input, output) :
+                               EncodeText<T>(input, output);
+    }
+    else
+    {
+        result = Decode<T>(input, output, options.raw);
+    }
+
+    return output.Close() && result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    static const struct option long_options[] =
+    {
+        {"signed", no_argument, nullptr, 's'},
+        {"raw", no_argument, nullptr, 'r'},
+        {"no-splice", no_argument, nullptr, 'n'},
+        {nullptr, 0, nullptr, 0}
+    };
+    Options options;
+    int option;
+
+    if (argc < 2) return Usage(argv[0]);
+
+    std::string command = argv[1];
+
+    if ((command != "encode") && (command != "decode") &&
+        (command != "count") && (command != "validate") &&
+        (command != "stats"))
+    {
+        return Usage(argv[0]);
+    }
+
+    // Parse the options following the command
+    while ((option = getopt_long(argc - 1, argv + 1, "srn", long_options,
+                                 nullptr)) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                options.is_signed = true;
+                break;
+
+            case 'r':
+                options.raw = true;
+                break;
+
+            case 'n':
+                options.splice = false;
+                break;
+
+            default:
+                return Usage(argv[0]);
+        }
+    }
+
+    int arguments = argc - 1 - optind;
+    bool has_output = (command == "encode") || (command == "decode");
+
+    if (arguments > (has_output ? 2 : 1)) return Usage(argv[0]);
+
+    std::string input_path = (arguments > 0) ? argv[optind + 1] : "-";
+    std::string output_path = (arguments > 1) ? argv[optind + 2] : "-";
+
+    Input input;
+
+    if (!input.Open(input_path)) return 1;
+
+    if (command == "count") return Count(input) ? 0 : 1;
+
+    bool result =
+        options.is_signed ?
+            Run<std::int64_t>(command, input, output_path, options) :
+            Run<std::uint64_t>(command, input, output_path, options);
+
+    return result ? 0 : 1;
+}